@@ -2,14 +2,21 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
-#include <pthread.h>
 #include <immintrin.h>
+#include "../rle/parallel.h"
 
+/*
+row bands are tasks on the libhybridrle worker pool (rle/parallel.c), one
+worker per CPU unless a thread count is given:
+
+    cc -O2 -mavx2 -pthread image_gen_avx_threads.c ../rle/parallel.c -o image_gen_avx_threads
+    ./image_gen_avx_threads [threads]
+*/
 #define WIDTH 1024
 #define HEIGHT 1024
-#define NUM_THREADS 8
+#define NUM_BANDS 32
 #define PIXELS_PER_REGISTER 32
-#define ROWS_PER_THREAD (HEIGHT / NUM_THREADS)
+#define ROWS_PER_BAND (HEIGHT / NUM_BANDS)
 
 typedef struct {
     uint8_t *image;
@@ -42,7 +49,7 @@ void *generate_part(void *arg) {
         }
     }
 
-    pthread_exit(NULL);
+    return NULL;
 }
 
 
@@ -56,20 +63,14 @@ void generate_image(const char *filename) {
     fprintf(file, "P5\n%d %d\n255\n", WIDTH, HEIGHT);
 
     uint8_t *image = aligned_alloc(32, WIDTH * HEIGHT);
-    pthread_t threads[NUM_THREADS];
-    ThreadData thread_data[NUM_THREADS];
+    ThreadData thread_data[NUM_BANDS];
 
-    for (int i = 0; i < NUM_THREADS; i++) {
+    for (int i = 0; i < NUM_BANDS; i++) {
         thread_data[i].image = image;
-        thread_data[i].start_row = i * ROWS_PER_THREAD;
-        thread_data[i].end_row = (i + 1) * ROWS_PER_THREAD;
-        pthread_create(&threads[i], NULL, generate_part, &thread_data[i]);
-    }
-
-    // Join threads
-    for (int i = 0; i < NUM_THREADS; i++) {
-        pthread_join(threads[i], NULL);
+        thread_data[i].start_row = i * ROWS_PER_BAND;
+        thread_data[i].end_row = (i + 1) * ROWS_PER_BAND;
     }
+    parallel_run(generate_part, thread_data, sizeof(ThreadData), NUM_BANDS);
 
     fwrite(image, 1, WIDTH * HEIGHT, file);
     fclose(file);
@@ -78,7 +79,8 @@ void generate_image(const char *filename) {
     printf("[MESSAGE] Image generated successfully\n");
 }
 
-int main() {
+int main(int argc, char **argv) {
+    if (argc > 1) parallel_set_threads(atoi(argv[1]));
     generate_image("image_avx_threads.pgm");
     return 0;
 }
@@ -0,0 +1,246 @@
+#include <string.h>
+#include "container.h"
+#include "huffman.h"
+#include "ans.h"
+
+// ----------------- Frequency Normalization -----------------
+void ans_normalize(const uint32_t freq[256], uint32_t normalized[256]) {
+    uint64_t total = 0;
+    for (int i = 0; i < 256; i++) total += freq[i];
+    memset(normalized, 0, 256 * sizeof(uint32_t));
+    if (!total) return;
+
+    uint32_t sum = 0;
+    int largest = 0;
+    for (int i = 0; i < 256; i++) {
+        if (!freq[i]) continue;
+        uint32_t scaled = (uint64_t)freq[i] * ANS_PROB_SCALE / total;
+        normalized[i] = scaled ? scaled : 1;
+        sum += normalized[i];
+        if (freq[i] > freq[largest]) largest = i;
+    }
+
+    // Rounding down undershoots, which the most frequent symbol absorbs; rare symbols raised to 1 can overshoot
+    if (sum < ANS_PROB_SCALE) normalized[largest] += ANS_PROB_SCALE - sum;
+    while (sum > ANS_PROB_SCALE) {
+        int top = largest;
+        for (int i = 0; i < 256; i++) {
+            if (normalized[i] > normalized[top]) top = i;
+        }
+        normalized[top]--;
+        sum--;
+    }
+}
+
+// ----------------- Encoding -----------------
+typedef struct {
+    uint32_t start;  // cumulative frequency of the symbols before it
+    uint32_t freq;
+    uint64_t x_max;  // renormalize when the state is at or above this; 2^32 for a lone symbol
+} AnsSymbol;
+
+// At most ANS_PROB_BITS bits per symbol, plus the rounding of each step and a partial word
+static size_t ans_stream_bound(size_t symbols) {
+    return symbols * ANS_PROB_BITS / 8 + symbols / 256 + 4;
+}
+
+size_t ans_compress_bound(size_t size) {
+    return ANS_HEADER_MAX_SIZE + ANS_STATES * ans_stream_bound((size + ANS_STATES - 1) / ANS_STATES);
+}
+
+// States are below 2^32 and x_max is at least 2^20, so one 16-bit word out always brings the state under it
+static inline void ans_encode(uint32_t *state, const AnsSymbol *symbol, uint8_t **ptr) {
+    uint32_t x = *state;
+    if (x >= symbol->x_max) {
+        *ptr -= 2;
+        put_le16(*ptr, x);
+        x >>= 16;
+    }
+    *state = ((x / symbol->freq) << ANS_PROB_BITS) + x % symbol->freq + symbol->start;
+}
+
+int ans_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    uint32_t freq[256], normalized[256];
+    count_frequencies(input, size, freq);
+    ans_normalize(freq, normalized);
+
+    AnsSymbol symbols[256];
+    memset(output, 0, 32);
+    size_t header_size = 32;
+    uint32_t start = 0;
+    for (int i = 0; i < 256; i++) {
+        if (!normalized[i]) continue;
+        symbols[i] = (AnsSymbol){
+            .start = start,
+            .freq = normalized[i],
+            .x_max = (uint64_t)((ANS_STATE_LOW >> ANS_PROB_BITS) << 16) * normalized[i]
+        };
+        start += normalized[i];
+        output[i >> 3] |= 1 << (i & 7);
+        put_le16(&output[header_size], normalized[i]);
+        header_size += 2;
+    }
+    uint8_t *states_out = output + header_size;
+    uint8_t *sizes_out = states_out + 4 * ANS_STATES;
+    header_size += 4 * ANS_STATES + 4 * (ANS_STATES - 1);
+
+    /*
+    rANS is last in, first out: stream k is coded backwards into region k of
+    ANS_STATES equal regions at the end of the output buffer, then the streams
+    are moved down in order, each landing below its region and above the
+    regions still to move
+    */
+    size_t region = ans_stream_bound((size + ANS_STATES - 1) / ANS_STATES);
+    uint8_t *end = output + ans_compress_bound(size);
+    uint8_t *region_end[ANS_STATES], *ptr[ANS_STATES];
+    uint32_t states[ANS_STATES];
+    for (int k = 0; k < ANS_STATES; k++) {
+        region_end[k] = ptr[k] = end - (ANS_STATES - 1 - k) * region;
+        states[k] = ANS_STATE_LOW;
+    }
+
+    size_t i = size;
+    while (i % ANS_STATES) {
+        i--;
+        ans_encode(&states[i % ANS_STATES], &symbols[input[i]], &ptr[i % ANS_STATES]);
+    }
+    // Four independent chains per round, so their divisions overlap
+    while (i) {
+        i -= ANS_STATES;
+        ans_encode(&states[3], &symbols[input[i + 3]], &ptr[3]);
+        ans_encode(&states[2], &symbols[input[i + 2]], &ptr[2]);
+        ans_encode(&states[1], &symbols[input[i + 1]], &ptr[1]);
+        ans_encode(&states[0], &symbols[input[i]], &ptr[0]);
+    }
+
+    size_t output_pos = header_size;
+    for (int k = 0; k < ANS_STATES; k++) {
+        size_t stream_size = region_end[k] - ptr[k];
+        put_le32(states_out + 4 * k, states[k]);
+        if (k < ANS_STATES - 1) put_le32(sizes_out + 4 * k, stream_size);
+        memmove(output + output_pos, ptr[k], stream_size);
+        output_pos += stream_size;
+    }
+
+    *output_size = output_pos;
+    return CONTAINER_OK;
+}
+
+// ----------------- Decoding -----------------
+/*
+one entry per slot of the probability range: symbol, slot - start and
+freq - 1 packed as 8 + 12 + 12 bits, so a step is one load
+*/
+#define ANS_ENTRY(symbol, bias, freq) ((uint32_t)(symbol) | (uint32_t)(bias) << 8 | (uint32_t)((freq) - 1) << 20)
+
+typedef struct {
+    const uint8_t *ptr;
+    const uint8_t *end;
+    int overrun;  // renormalization wanted bytes past the end
+} AnsReader;
+
+/*
+a step leaves the state at least 2^4, so one 16-bit word brings it back
+above ANS_STATE_LOW; whether a word is needed is close to random on real
+data, so it is selected rather than branched on
+*/
+static inline uint8_t ans_decode_fast(const uint32_t *table, uint32_t *state, const uint8_t **ptr) {
+    uint32_t x = *state;
+    uint32_t entry = table[x & (ANS_PROB_SCALE - 1)];
+    x = ((entry >> 20) + 1) * (x >> ANS_PROB_BITS) + ((entry >> 8) & (ANS_PROB_SCALE - 1));
+    uint32_t word = get_le16(*ptr);
+    uint32_t renormalize = x < ANS_STATE_LOW;
+    uint32_t mask = -renormalize;  // a mask, since compilers tend to turn the select back into a branch
+    *state = (x & ~mask) | ((x << 16 | word) & mask);
+    *ptr += 2 * renormalize;
+    return entry;
+}
+
+static inline uint8_t ans_decode(const uint32_t *table, uint32_t *state, AnsReader *reader) {
+    uint32_t x = *state;
+    uint32_t entry = table[x & (ANS_PROB_SCALE - 1)];
+    x = ((entry >> 20) + 1) * (x >> ANS_PROB_BITS) + ((entry >> 8) & (ANS_PROB_SCALE - 1));
+    if (x < ANS_STATE_LOW) {
+        if (reader->end - reader->ptr < 2) {
+            reader->overrun = 1;
+        } else {
+            x = x << 16 | get_le16(reader->ptr);
+            reader->ptr += 2;
+        }
+    }
+    *state = x;
+    return entry;
+}
+
+int ans_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    if (input_size < 32) return CONTAINER_ERR_FORMAT;
+
+    uint32_t table[ANS_PROB_SCALE];
+    size_t input_pos = 32;
+    uint32_t start = 0;
+    for (int i = 0; i < 256; i++) {
+        if (!(input[i >> 3] >> (i & 7) & 1)) continue;
+        if (input_size - input_pos < 2) return CONTAINER_ERR_FORMAT;
+        uint32_t freq = get_le16(&input[input_pos]);
+        input_pos += 2;
+        if (!freq || freq > ANS_PROB_SCALE - start) return CONTAINER_ERR_FORMAT;
+        for (uint32_t slot = 0; slot < freq; slot++) table[start + slot] = ANS_ENTRY(i, slot, freq);
+        start += freq;
+    }
+    if (size && start != ANS_PROB_SCALE) return CONTAINER_ERR_FORMAT;
+
+    size_t header_end = input_pos + 4 * ANS_STATES + 4 * (ANS_STATES - 1);
+    if (input_size < header_end) return CONTAINER_ERR_FORMAT;
+    uint32_t states[ANS_STATES];
+    AnsReader readers[ANS_STATES];
+    size_t stream_pos = header_end;
+    for (int k = 0; k < ANS_STATES; k++) {
+        states[k] = get_le32(&input[input_pos + 4 * k]);
+        if (states[k] < ANS_STATE_LOW) return CONTAINER_ERR_FORMAT;
+        // Stream sizes from the jump table, the last stream takes the rest
+        size_t stream_size = k < ANS_STATES - 1 ? get_le32(&input[input_pos + 4 * ANS_STATES + 4 * k])
+                                                : input_size - stream_pos;
+        if (stream_size > input_size - stream_pos) return CONTAINER_ERR_FORMAT;
+        readers[k] = (AnsReader){ .ptr = input + stream_pos, .end = input + stream_pos + stream_size, .overrun = 0 };
+        stream_pos += stream_size;
+    }
+
+    /*
+    each state reads its own stream, so the four decode chains share nothing;
+    a round takes at most one word from each stream, which bounds how many
+    rounds can run without checking for the end
+    */
+    size_t rounds = size / ANS_STATES, round = 0;
+    while (round < rounds) {
+        size_t safe = rounds - round;
+        for (int k = 0; k < ANS_STATES; k++) {
+            size_t room = (readers[k].end - readers[k].ptr) / 2;
+            if (room < safe) safe = room;
+        }
+        if (!safe) break;
+
+        uint32_t s0 = states[0], s1 = states[1], s2 = states[2], s3 = states[3];
+        const uint8_t *p0 = readers[0].ptr, *p1 = readers[1].ptr, *p2 = readers[2].ptr, *p3 = readers[3].ptr;
+        uint8_t *out = output + round * ANS_STATES;
+        for (size_t r = 0; r < safe; r++, out += ANS_STATES) {
+            out[0] = ans_decode_fast(table, &s0, &p0);
+            out[1] = ans_decode_fast(table, &s1, &p1);
+            out[2] = ans_decode_fast(table, &s2, &p2);
+            out[3] = ans_decode_fast(table, &s3, &p3);
+        }
+        states[0] = s0, states[1] = s1, states[2] = s2, states[3] = s3;
+        readers[0].ptr = p0, readers[1].ptr = p1, readers[2].ptr = p2, readers[3].ptr = p3;
+        round += safe;
+    }
+    for (size_t i = round * ANS_STATES; i < size; i++) {
+        output[i] = ans_decode(table, &states[i % ANS_STATES], &readers[i % ANS_STATES]);
+    }
+
+    // Valid streams are used up exactly and leave every state where the encoder started it
+    for (int k = 0; k < ANS_STATES; k++) {
+        if (readers[k].overrun || readers[k].ptr != readers[k].end || states[k] != ANS_STATE_LOW) {
+            return CONTAINER_ERR_FORMAT;
+        }
+    }
+    return CONTAINER_OK;
+}
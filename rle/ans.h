@@ -0,0 +1,32 @@
+#ifndef ANS_H
+#define ANS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ----------------- Interleaved rANS -----------------
+/*
+order-0 range ANS with 32-bit states renormalized 16 bits at a time; symbol
+i is coded by state i % ANS_STATES into that state's own stream, so the
+decoder runs ANS_STATES independent chains
+
+payload: a 32-byte bitmap of the symbols present, their normalized
+frequencies (u16 each, summing to 1 << ANS_PROB_BITS), the final encoder
+states (u32 each), the byte sizes of all streams but the last (u32 each),
+then the streams of u16 words; every stream must end exactly with its state
+back at ANS_STATE_LOW, which catches corrupt input
+*/
+#define ANS_PROB_BITS 12
+#define ANS_PROB_SCALE (1u << ANS_PROB_BITS)
+#define ANS_STATES 4  // the coding rounds in ans.c are written out for four
+#define ANS_STATE_LOW (1u << 16)  // states stay in [ANS_STATE_LOW, 2^32)
+#define ANS_HEADER_MAX_SIZE (32 + 2 * 256 + 4 * ANS_STATES + 4 * (ANS_STATES - 1))
+
+// Frequencies scaled to sum to ANS_PROB_SCALE, every present symbol keeping at least 1
+void ans_normalize(const uint32_t freq[256], uint32_t normalized[256]);
+
+size_t ans_compress_bound(size_t size);
+int ans_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size);
+int ans_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+#endif
@@ -0,0 +1,790 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "hybridrle.h"
+#include "container.h"
+#include "huffman.h"
+#include "ans.h"
+#include "cm.h"
+#include "rle.h"
+#include "mtf.h"
+#include "bwt.h"
+#include "filter.h"
+#include "fileio.h"
+#include "parallel.h"
+
+/*
+benchmark harness for libhybridrle
+
+    bench [-r runs] [-s size_mb] [-b block_size] [-t threads] [-w window] [-f filter]
+          [-e entropy] [-c codec,...] [-o out.csv] [file ...]
+
+the corpus is every file on the command line plus generated data (PGM
+images, a single repeated byte, low- and high-entropy bytes, a CSV table);
+generators use fixed
+seeds, so two runs see identical input
+
+every codec and every pipeline stage runs `runs` times on each dataset in a
+forked child, which gives a clean peak RSS per case; output is CSV with one
+row per (dataset, codec) and one per (dataset, stage):
+
+    kind,dataset,name,bytes_in,bytes_out,ratio,compress_mbps_median,compress_mbps_best,
+    decompress_mbps_median,decompress_mbps_best,peak_rss_kb,runs
+
+codecs use hrle_threads() workers (-t, default one per CPU), BWT
+sub-blocks of hrle_bwt_window() bytes (-w, default whole blocks) and the
+pre-BWT filter hrle_bwt_filter() (-f, default auto) and the entropy
+coder choice hrle_entropy() (-e fixed or auto, default fixed); ratio is
+bytes_out / bytes_in; stages time the forward and inverse transform
+separately over block_size pieces, without the container around them;
+the histogram stage times count_frequencies forward and the single-table
+loop it replaced as its inverse, which also checks the counts; the
+dispatch stages time 16K parallel batches on the worker pool against a
+thread per helper per batch, as before the pool; the filter
+stage fails if a forced filter (-f other than auto) is missing from a
+block's header
+*/
+
+#define MAX_DATASETS 32
+#define MAX_RUNS 64
+
+typedef struct {
+    char name[64];
+    uint8_t *data;
+    size_t size;
+} Dataset;
+
+typedef struct {
+    int ok;
+    size_t bytes_out;
+    double compress_seconds[MAX_RUNS];
+    double decompress_seconds[MAX_RUNS];
+} CaseResult;
+
+static int runs = 5;
+static uint32_t block_size = HRLE_DEFAULT_BLOCK_SIZE;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *xmalloc(size_t size) {
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return p;
+}
+
+// ----------------- Generated Corpus -----------------
+// xorshift64*, fixed seeds keep the corpus identical between runs and machines
+static uint64_t rng_state;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static size_t pgm_header(uint8_t *out, int width, int height) {
+    return sprintf((char *)out, "P5\n%d %d\n255\n", width, height);
+}
+
+// Horizontal ramp, as written by image-gen/image_gen_avx_threads.c
+static void gen_pgm_gradient(Dataset *d, size_t size) {
+    int width = 1024, height = size / width;
+    d->data = xmalloc(32 + (size_t)width * height);
+    size_t pos = pgm_header(d->data, width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) d->data[pos++] = x % 256;
+    }
+    d->size = pos;
+}
+
+// Flat rectangles on a flat background with light sensor-style noise
+static void gen_pgm_shapes(Dataset *d, size_t size) {
+    int width = 1024, height = size / width;
+    uint8_t *pixels = xmalloc((size_t)width * height);
+    memset(pixels, 40, (size_t)width * height);
+    rng_state = 0x5eed0001;
+    for (int r = 0; r < height / 16; r++) {
+        int x0 = rng_next() % width, y0 = rng_next() % height;
+        int w = 16 + rng_next() % 256, h = 16 + rng_next() % 256;
+        uint8_t value = rng_next();
+        for (int y = y0; y < y0 + h && y < height; y++) {
+            memset(&pixels[(size_t)y * width + x0], value, x0 + w < width ? w : width - x0);
+        }
+    }
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        if ((rng_next() & 15) == 0) pixels[i] += (rng_next() & 3) - 1;
+    }
+
+    d->data = xmalloc(32 + (size_t)width * height);
+    size_t pos = pgm_header(d->data, width, height);
+    memcpy(d->data + pos, pixels, (size_t)width * height);
+    d->size = pos + (size_t)width * height;
+    free(pixels);
+}
+
+// One byte value throughout, the worst case for a single-table histogram
+static void gen_uniform(Dataset *d, size_t size) {
+    d->data = xmalloc(size);
+    memset(d->data, 'a', size);
+    d->size = size;
+}
+
+// Long runs of a handful of byte values
+static void gen_low_entropy(Dataset *d, size_t size) {
+    d->data = xmalloc(size);
+    rng_state = 0x5eed0002;
+    for (size_t pos = 0; pos < size;) {
+        size_t run = 1 + rng_next() % 200;
+        if (run > size - pos) run = size - pos;
+        memset(d->data + pos, "aabbbcz\n"[rng_next() & 7], run);
+        pos += run;
+    }
+    d->size = size;
+}
+
+// Uniformly random bytes, incompressible
+static void gen_high_entropy(Dataset *d, size_t size) {
+    d->data = xmalloc(size + 8);
+    rng_state = 0x5eed0003;
+    for (size_t pos = 0; pos < size; pos += 8) {
+        uint64_t word = rng_next();
+        memcpy(d->data + pos, &word, 8);
+    }
+    d->size = size;
+}
+
+// Sensor-log style table: id, timestamp, category, two readings
+static void gen_csv(Dataset *d, size_t size) {
+    static const char *categories[] = { "north", "south", "east", "west", "central" };
+    d->data = xmalloc(size + 128);
+    rng_state = 0x5eed0004;
+
+    size_t pos = sprintf((char *)d->data, "id,timestamp,region,temperature,pressure\n");
+    for (uint64_t id = 1; pos < size; id++) {
+        pos += sprintf((char *)d->data + pos, "%llu,%llu,%s,%.2f,%llu\n", (unsigned long long)id,
+                       1700000000ULL + id * 15, categories[rng_next() % 5],
+                       15.0 + (rng_next() % 2000) / 100.0, 990 + (unsigned long long)(rng_next() % 40));
+    }
+    d->size = pos;
+}
+
+// ----------------- Cases -----------------
+typedef size_t (*StageForward)(const uint8_t *in, size_t size, uint8_t *out, void *scratch);
+typedef int (*StageInverse)(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch);
+
+static size_t stage_crc_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    put_le32(out, crc32_update(0, in, size));
+    return 4;
+}
+
+static int stage_crc_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)in_size;
+    (void)scratch;
+    return crc32_update(0, out, size) == get_le32(in) ? CONTAINER_OK : CONTAINER_ERR_CHECKSUM;
+}
+
+/*
+dispatch stages: the block is cut into DISPATCH_PAYLOAD pieces, each
+checksummed by one parallel batch of DISPATCH_TASK bytes per task (fewer
+tasks than workers once -t goes past 4), so the time is mostly the cost of
+handing small batches out; dispatch-pool goes through parallel_run,
+dispatch-spawn through the thread-per-call runner it replaced
+*/
+#define DISPATCH_PAYLOAD (16u << 10)
+#define DISPATCH_TASK (4u << 10)
+#define DISPATCH_MAX_TASKS (DISPATCH_PAYLOAD / DISPATCH_TASK)
+
+// Tasks per payload: one per worker, DISPATCH_MAX_TASKS at most
+static int dispatch_tasks(void) {
+    return parallel_threads() < (int)DISPATCH_MAX_TASKS ? parallel_threads() : (int)DISPATCH_MAX_TASKS;
+}
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    uint32_t crc;
+} DispatchTask;
+
+static void *dispatch_task(void *arg) {
+    DispatchTask *task = arg;
+    task->crc = crc32_update(0, task->data, task->size);
+    return NULL;
+}
+
+typedef struct {
+    void *(*fn)(void *);
+    uint8_t *tasks;
+    size_t task_size;
+    int count;
+    int next;
+} SpawnQueue;
+
+static void *spawn_worker(void *arg) {
+    SpawnQueue *queue = arg;
+    for (;;) {
+        int i = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+        if (i >= queue->count) break;
+        queue->fn(queue->tasks + (size_t)i * queue->task_size);
+    }
+    return NULL;
+}
+
+// parallel_run as it was before the pool: helpers created and joined on every call
+static void spawn_run(void *(*fn)(void *), void *tasks, size_t task_size, int count) {
+    SpawnQueue queue = { .fn = fn, .tasks = tasks, .task_size = task_size, .count = count, .next = 0 };
+    int workers = parallel_threads() < count ? parallel_threads() : count;
+    pthread_t threads[DISPATCH_MAX_TASKS];
+    int started = 0;
+    while (started < workers - 1 && pthread_create(&threads[started], NULL, spawn_worker, &queue) == 0) started++;
+    spawn_worker(&queue);
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+}
+
+static size_t dispatch_forward(const uint8_t *in, size_t size, uint8_t *out,
+                               void (*run)(void *(*)(void *), void *, size_t, int)) {
+    int count = dispatch_tasks();
+    DispatchTask tasks[DISPATCH_MAX_TASKS];
+    size_t out_size = 0;
+    for (size_t start = 0; start < size; start += DISPATCH_PAYLOAD) {
+        size_t payload = size - start < DISPATCH_PAYLOAD ? size - start : DISPATCH_PAYLOAD;
+        for (int t = 0; t < count; t++) {
+            tasks[t].data = in + start + payload * t / count;
+            tasks[t].size = payload * (t + 1) / count - payload * t / count;
+        }
+        run(dispatch_task, tasks, sizeof(DispatchTask), count);
+        for (int t = 0; t < count; t++, out_size += 4) put_le32(out + out_size, tasks[t].crc);
+    }
+    return out_size;
+}
+
+static size_t stage_dispatch_pool_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    return dispatch_forward(in, size, out, parallel_run);
+}
+
+static size_t stage_dispatch_spawn_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    return dispatch_forward(in, size, out, spawn_run);
+}
+
+// Both stages check the checksums serially
+static int stage_dispatch_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    size_t in_pos = 0;
+    int count = dispatch_tasks();
+    for (size_t start = 0; start < size; start += DISPATCH_PAYLOAD) {
+        size_t payload = size - start < DISPATCH_PAYLOAD ? size - start : DISPATCH_PAYLOAD;
+        for (int t = 0; t < count; t++, in_pos += 4) {
+            size_t first = payload * t / count, last = payload * (t + 1) / count;
+            if (in_pos + 4 > in_size || crc32_update(0, out + start + first, last - first) != get_le32(in + in_pos)) {
+                return CONTAINER_ERR_CHECKSUM;
+            }
+        }
+    }
+    return in_pos == in_size ? CONTAINER_OK : CONTAINER_ERR_FORMAT;
+}
+
+static size_t stage_histogram_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    uint32_t freq[256];
+    count_frequencies(in, size, freq);
+    for (int c = 0; c < 256; c++) put_le32(out + 4 * c, freq[c]);
+    return 4 * 256;
+}
+
+// Reference single-table count
+static int stage_histogram_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)in_size;
+    (void)scratch;
+    uint32_t freq[256] = {0};
+    for (size_t i = 0; i < size; i++) freq[out[i]]++;
+    for (int c = 0; c < 256; c++) {
+        if (freq[c] != get_le32(in + 4 * c)) return CONTAINER_ERR_CHECKSUM;
+    }
+    return CONTAINER_OK;
+}
+
+static size_t stage_huffman_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    size_t out_size = 0;
+    huffman_compress(in, size, out, &out_size);
+    return out_size;
+}
+
+static int stage_huffman_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return huffman_decompress(in, in_size, out, size);
+}
+
+static size_t stage_huffman_contiguous_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    size_t out_size = 0;
+    huffman_compress_contiguous(in, size, out, &out_size);
+    return out_size;
+}
+
+static size_t stage_huffman_x4_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    size_t out_size = 0;
+    huffman_x4_compress(in, size, out, &out_size);
+    return out_size;
+}
+
+static int stage_huffman_x4_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return huffman_x4_decompress(in, in_size, out, size);
+}
+
+static size_t stage_huffman_x16_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    size_t out_size = 0;
+    huffman_gather_compress(in, size, out, &out_size, HUFF_GATHER_MAX_STREAMS);
+    return out_size;
+}
+
+static int stage_huffman_x16_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return huffman_gather_decompress(in, in_size, out, size);
+}
+
+static size_t stage_ans_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    size_t out_size = 0;
+    ans_compress(in, size, out, &out_size);
+    return out_size;
+}
+
+static int stage_ans_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return ans_decompress(in, in_size, out, size);
+}
+
+static size_t stage_cm_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    size_t out_size = 0;
+    cm_compress(in, size, out, &out_size);
+    return out_size;
+}
+
+static int stage_cm_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return cm_decompress(in, in_size, out, size);
+}
+
+static size_t stage_mtf_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    mtf_encode(in, out, size);
+    return size;
+}
+
+static int stage_mtf_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)in_size;
+    (void)scratch;
+    mtf_decode(in, out, size);
+    return CONTAINER_OK;
+}
+
+// The BWT index travels in the scratch slot
+static size_t stage_bwt_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    bwt_forward(in, out, size, scratch);
+    return size;
+}
+
+static int stage_bwt_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)in_size;
+    return bwt_inverse(in, out, size, scratch);
+}
+
+// The chosen filter (FILTER_NONE copies the block) and its parameter lead the output
+static size_t stage_filter_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    uint32_t param = 0;
+    const Filter *filter = filter_select(in, size, &param);
+    size_t out_size = size;
+    out[0] = filter ? filter->id : FILTER_NONE;
+    put_le32(out + 1, param);
+    if (!filter) memcpy(out + 5, in, size);
+    else if (filter->forward(in, size, param, out + 5, &out_size)) return 0;
+    return 5 + out_size;
+}
+
+static int stage_filter_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    if (in_size < 5) return CONTAINER_ERR_FORMAT;
+    // A forced filter has to show in the header of every block it applies to
+    int mode = filter_mode();
+    if (mode != FILTER_AUTO && size >= FILTER_MIN_SIZE && in[0] != mode) return CONTAINER_ERR_FORMAT;
+    const Filter *filter = filter_get(in[0]);
+    if (!filter) {
+        memcpy(out, in + 5, size);
+        return CONTAINER_OK;
+    }
+    return filter->inverse(in + 5, in_size - 5, get_le32(in + 1), out, size);
+}
+
+static size_t stage_block_rle_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    return block_rle_compress(in, size, out);
+}
+
+static int stage_block_rle_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return block_rle_decompress(in, in_size, out, size);
+}
+
+// The codec's framing, chunks on hrle_threads() workers; compare with block-rle for the framing's gain
+static size_t stage_block_rle_chunked_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    size_t out_size;
+    return block_rle_compress_chunked(in, size, out, &out_size) ? 0 : out_size;
+}
+
+static int stage_block_rle_chunked_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return block_rle_decompress_chunked(in, in_size, out, size);
+}
+
+static size_t stage_byte_rle_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    return byte_rle_compress(in, size, out);
+}
+
+static int stage_byte_rle_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return byte_rle_decompress(in, in_size, out, size);
+}
+
+static size_t stage_zero_rle_forward(const uint8_t *in, size_t size, uint8_t *out, void *scratch) {
+    (void)scratch;
+    return zero_rle_encode(in, size, out);
+}
+
+static int stage_zero_rle_inverse(const uint8_t *in, size_t in_size, uint8_t *out, size_t size, void *scratch) {
+    (void)scratch;
+    return zero_rle_decode(in, in_size, out, size);
+}
+
+typedef struct {
+    const char *name;
+    StageForward forward;
+    StageInverse inverse;
+    int check_only;  // inverse checks the original bytes rather than decoding
+} Stage;
+
+static const Stage stages[] = {
+    { "crc32", stage_crc_forward, stage_crc_inverse, 1 },
+    { "dispatch-pool", stage_dispatch_pool_forward, stage_dispatch_inverse, 1 },
+    { "dispatch-spawn", stage_dispatch_spawn_forward, stage_dispatch_inverse, 1 },
+    { "histogram", stage_histogram_forward, stage_histogram_inverse, 1 },
+    { "huffman", stage_huffman_forward, stage_huffman_inverse, 0 },
+    { "huffman-contiguous", stage_huffman_contiguous_forward, stage_huffman_inverse, 0 },
+    { "huffman-x4", stage_huffman_x4_forward, stage_huffman_x4_inverse, 0 },
+    { "huffman-x16", stage_huffman_x16_forward, stage_huffman_x16_inverse, 0 },
+    { "ans", stage_ans_forward, stage_ans_inverse, 0 },
+    { "cm", stage_cm_forward, stage_cm_inverse, 0 },
+    { "mtf", stage_mtf_forward, stage_mtf_inverse, 0 },
+    { "bwt", stage_bwt_forward, stage_bwt_inverse, 0 },
+    { "filter", stage_filter_forward, stage_filter_inverse, 0 },
+    { "block-rle", stage_block_rle_forward, stage_block_rle_inverse, 0 },
+    { "block-rle-chunked", stage_block_rle_chunked_forward, stage_block_rle_chunked_inverse, 0 },
+    { "byte-rle", stage_byte_rle_forward, stage_byte_rle_inverse, 0 },
+    { "zero-rle", stage_zero_rle_forward, stage_zero_rle_inverse, 0 }
+};
+#define STAGE_COUNT (int)(sizeof(stages) / sizeof(stages[0]))
+
+static void run_codec(const Dataset *d, int codec, CaseResult *result) {
+    size_t capacity = hrle_compress_bound(codec, d->size, block_size);
+    uint8_t *compressed = xmalloc(capacity);
+    uint8_t *decompressed = xmalloc(d->size);
+
+    for (int r = 0; r < runs; r++) {
+        size_t out_size;
+        double start = now();
+        if (hrle_compress(codec, block_size, d->data, d->size, compressed, capacity, &result->bytes_out)) return;
+        result->compress_seconds[r] = now() - start;
+
+        start = now();
+        if (hrle_decompress(compressed, result->bytes_out, decompressed, d->size, &out_size)) return;
+        result->decompress_seconds[r] = now() - start;
+        if (out_size != d->size || memcmp(decompressed, d->data, d->size) != 0) return;
+    }
+    result->ok = 1;
+}
+
+static void run_stage(const Dataset *d, const Stage *stage, CaseResult *result) {
+    size_t blocks = (d->size + block_size - 1) / block_size;
+    size_t *sizes = xmalloc(blocks * sizeof(size_t));
+    BwtIndex *scratch = xmalloc(blocks * sizeof(BwtIndex));  // per-block side information, only BWT has any
+    uint8_t *encoded = xmalloc(blocks * (huffman_compress_bound(block_size) + 2 * (size_t)block_size));
+    size_t slot = huffman_compress_bound(block_size) + 2 * (size_t)block_size;
+    uint8_t *decoded = xmalloc(d->size);
+
+    for (int r = 0; r < runs; r++) {
+        result->bytes_out = 0;
+        double start = now();
+        for (size_t b = 0; b < blocks; b++) {
+            size_t size = b + 1 < blocks ? block_size : d->size - b * block_size;
+            sizes[b] = stage->forward(d->data + b * block_size, size, encoded + b * slot, &scratch[b]);
+            result->bytes_out += sizes[b];
+        }
+        result->compress_seconds[r] = now() - start;
+
+        if (stage->check_only) memcpy(decoded, d->data, d->size);
+
+        start = now();
+        for (size_t b = 0; b < blocks; b++) {
+            size_t size = b + 1 < blocks ? block_size : d->size - b * block_size;
+            if (stage->inverse(encoded + b * slot, sizes[b], decoded + b * block_size, size, &scratch[b])) return;
+        }
+        result->decompress_seconds[r] = now() - start;
+        if (memcmp(decoded, d->data, d->size) != 0) return;
+    }
+    result->ok = 1;
+}
+
+// Runs one case in a child process so its peak RSS is its own
+static int run_case(const Dataset *d, int codec, const Stage *stage, CaseResult *result, long *peak_rss_kb) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        close(fds[0]);
+        CaseResult local = {0};
+        if (stage) run_stage(d, stage, &local);
+        else run_codec(d, codec, &local);
+        ssize_t n = write(fds[1], &local, sizeof(local));
+        _exit(n == sizeof(local) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    memset(result, 0, sizeof(*result));
+    size_t got = 0;
+    while (got < sizeof(*result)) {
+        ssize_t n = read(fds[0], (uint8_t *)result + got, sizeof(*result) - got);
+        if (n <= 0) break;
+        got += n;
+    }
+    close(fds[0]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) return -1;
+    *peak_rss_kb = usage.ru_maxrss;
+    return got == sizeof(*result) && WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+// ----------------- Reporting -----------------
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Median and best throughput over the runs
+static void throughput(const double *seconds, size_t bytes, double *median, double *best) {
+    double sorted[MAX_RUNS];
+    memcpy(sorted, seconds, runs * sizeof(double));
+    qsort(sorted, runs, sizeof(double), compare_double);
+
+    double mid = runs % 2 ? sorted[runs / 2] : (sorted[runs / 2 - 1] + sorted[runs / 2]) / 2;
+    *median = mid > 0 ? bytes / mid / 1e6 : 0;
+    *best = sorted[0] > 0 ? bytes / sorted[0] / 1e6 : 0;
+}
+
+static void report(FILE *out, const char *kind, const Dataset *d, const char *name,
+                   const CaseResult *result, long peak_rss_kb) {
+    if (!result->ok) {
+        fprintf(out, "%s,%s,%s,%zu,,,,,,,%ld,%d\n", kind, d->name, name, d->size, peak_rss_kb, runs);
+        fprintf(stderr, "%s %s on %s: FAILED\n", kind, name, d->name);
+        return;
+    }
+
+    double c_median, c_best, d_median, d_best;
+    throughput(result->compress_seconds, d->size, &c_median, &c_best);
+    throughput(result->decompress_seconds, d->size, &d_median, &d_best);
+    fprintf(out, "%s,%s,%s,%zu,%zu,%.4f,%.1f,%.1f,%.1f,%.1f,%ld,%d\n", kind, d->name, name, d->size,
+            result->bytes_out, d->size ? (double)result->bytes_out / d->size : 0, c_median, c_best,
+            d_median, d_best, peak_rss_kb, runs);
+    fflush(out);
+}
+
+// ----------------- MAIN -----------------
+static void usage(void) {
+    fprintf(stderr, "usage: bench [-r runs] [-s size_mb] [-b block_size] [-t threads] [-w window] [-f filter] "
+                    "[-e fixed|auto] [-c codec,...] [-o out.csv] [file ...]\n");
+    exit(1);
+}
+
+// Whole numbers in [min, max] only; anything else is a usage error
+static long parse_int(const char *arg, long min, long max) {
+    char *end;
+    long value = strtol(arg, &end, 10);
+    if (end == arg || *end || value < min || value > max) usage();
+    return value;
+}
+
+// Block and window sizes, in bytes or with a K or M suffix as hrle takes them
+static uint32_t parse_size(const char *arg) {
+    char *end;
+    unsigned long long size = strtoull(arg, &end, 10);
+    if (end == arg || arg[0] == '-') usage();
+    if (*end == 'K' || *end == 'k') size <<= 10, end++;
+    else if (*end == 'M' || *end == 'm') size <<= 20, end++;
+    if (*end || size == 0 || size > HRLE_MAX_BLOCK_SIZE) usage();
+    return size;
+}
+
+int main(int argc, char **argv) {
+    size_t generated_size = 8u << 20;
+    const char *codec_list = "raw,huffman,block-rle,byte-rle,mtf-huffman,bwt,huffman-x4,huffman-x16,ans,mtf-ans,bwt-ans,bwt-cm";
+    const char *output_filename = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:s:b:t:w:f:e:c:o:")) != -1) {
+        switch (opt) {
+            case 'r': runs = parse_int(optarg, 1, MAX_RUNS); break;
+            case 's': {
+                char *end;
+                double size_mb = strtod(optarg, &end);
+                if (end == optarg || *end || !(size_mb > 0 && size_mb <= 4096)) usage();
+                generated_size = (size_t)(size_mb * (1u << 20));
+                break;
+            }
+            case 'b': block_size = parse_size(optarg); break;
+            case 't': hrle_set_threads(parse_int(optarg, 1, 1024)); break;
+            case 'w': hrle_set_bwt_window(parse_size(optarg)); break;
+            case 'f':
+                if (hrle_filter_from_name(optarg) == HRLE_ERR_RANGE) usage();
+                hrle_set_bwt_filter(hrle_filter_from_name(optarg));
+                break;
+            case 'e':
+                if (strcmp(optarg, "fixed") == 0) hrle_set_entropy(HRLE_ENTROPY_FIXED);
+                else if (strcmp(optarg, "auto") == 0) hrle_set_entropy(HRLE_ENTROPY_AUTO);
+                else usage();
+                break;
+            case 'c': codec_list = optarg; break;
+            case 'o': output_filename = optarg; break;
+            default: usage();
+        }
+    }
+    if (runs < 1 || runs > MAX_RUNS || generated_size < 4096 || block_size == 0 ||
+        block_size > HRLE_MAX_BLOCK_SIZE) {
+        usage();
+    }
+
+    // Selected codecs; a stage runs when a selected codec uses it
+    int codecs[16], codec_count = 0;
+    char *list = strdup(codec_list);
+    for (char *name = strtok(list, ","); name && codec_count < 16; name = strtok(NULL, ",")) {
+        codecs[codec_count] = hrle_codec_from_name(name);
+        if (codecs[codec_count] < 0) {
+            fprintf(stderr, "Unknown codec: %s\n", name);
+            exit(1);
+        }
+        codec_count++;
+    }
+    free(list);
+
+    Dataset datasets[MAX_DATASETS];
+    int dataset_count = 0;
+    for (int i = optind; i < argc && dataset_count < MAX_DATASETS; i++) {
+        Dataset *d = &datasets[dataset_count++];
+        d->data = read_file(argv[i], &d->size);
+        if (!d->data) {
+            fprintf(stderr, "Error reading file: %s\n", argv[i]);
+            exit(1);
+        }
+        const char *base = strrchr(argv[i], '/');
+        snprintf(d->name, sizeof(d->name), "%s", base ? base + 1 : argv[i]);
+    }
+
+    static const struct {
+        const char *name;
+        void (*generate)(Dataset *, size_t);
+    } generators[] = {
+        { "gen-pgm-gradient", gen_pgm_gradient },
+        { "gen-pgm-shapes", gen_pgm_shapes },
+        { "gen-uniform", gen_uniform },
+        { "gen-low-entropy", gen_low_entropy },
+        { "gen-high-entropy", gen_high_entropy },
+        { "gen-csv", gen_csv }
+    };
+    for (size_t g = 0; g < sizeof(generators) / sizeof(generators[0]) && dataset_count < MAX_DATASETS; g++) {
+        Dataset *d = &datasets[dataset_count++];
+        snprintf(d->name, sizeof(d->name), "%s", generators[g].name);
+        generators[g].generate(d, generated_size);
+    }
+
+    FILE *out = output_filename ? fopen(output_filename, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error opening file: %s\n", output_filename);
+        exit(1);
+    }
+    fprintf(out, "# hybridrle bench %d.%d runs=%d block_size=%u threads=%d bwt_window=%u bwt_filter=%s entropy=%s\n",
+            HRLE_VERSION_MAJOR, HRLE_VERSION_MINOR, runs, block_size, hrle_threads(), hrle_bwt_window(),
+            hrle_filter_name(hrle_bwt_filter()), hrle_entropy() == HRLE_ENTROPY_AUTO ? "auto" : "fixed");
+    fprintf(out, "kind,dataset,name,bytes_in,bytes_out,ratio,compress_mbps_median,compress_mbps_best,"
+                 "decompress_mbps_median,decompress_mbps_best,peak_rss_kb,runs\n");
+
+    int failures = 0;
+    for (int i = 0; i < dataset_count; i++) {
+        const Dataset *d = &datasets[i];
+        CaseResult result;
+        long peak_rss_kb = 0;
+
+        for (int c = 0; c < codec_count; c++) {
+            if (run_case(d, codecs[c], NULL, &result, &peak_rss_kb) != 0) result.ok = 0;
+            failures += !result.ok;
+            report(out, "codec", d, hrle_codec_name(codecs[c]), &result, peak_rss_kb);
+        }
+
+        for (int s = 0; s < STAGE_COUNT; s++) {
+            int used = strcmp(stages[s].name, "crc32") == 0 || strncmp(stages[s].name, "dispatch-", 9) == 0;
+            for (int c = 0; c < codec_count; c++) {
+                int codec = codecs[c];
+                const char *name = stages[s].name;
+                if (strcmp(name, hrle_codec_name(codec)) == 0 ||
+                    (strcmp(name, "huffman-contiguous") == 0 && codec == HRLE_CODEC_HUFFMAN) ||
+                    (strcmp(name, "huffman") == 0 && (codec == HRLE_CODEC_MTF_HUFFMAN || codec == HRLE_CODEC_BWT)) ||
+                    (strcmp(name, "ans") == 0 && (codec == HRLE_CODEC_MTF_ANS || codec == HRLE_CODEC_BWT_ANS)) ||
+                    (strcmp(name, "histogram") == 0 && codec != HRLE_CODEC_RAW && codec != HRLE_CODEC_BLOCK_RLE &&
+                     codec != HRLE_CODEC_BYTE_RLE && codec != HRLE_CODEC_BWT_CM) ||
+                    (strcmp(name, "cm") == 0 && codec == HRLE_CODEC_BWT_CM) ||
+                    (strcmp(name, "block-rle-chunked") == 0 && codec == HRLE_CODEC_BLOCK_RLE) ||
+                    (strcmp(name, "mtf") == 0 && (codec == HRLE_CODEC_MTF_HUFFMAN || codec == HRLE_CODEC_BWT ||
+                                                  codec == HRLE_CODEC_MTF_ANS || codec == HRLE_CODEC_BWT_ANS ||
+                                                  codec == HRLE_CODEC_BWT_CM)) ||
+                    (strcmp(name, "zero-rle") == 0 && (codec == HRLE_CODEC_BWT || codec == HRLE_CODEC_BWT_ANS)) ||
+                    ((strcmp(name, "bwt") == 0 || strcmp(name, "filter") == 0) &&
+                     (codec == HRLE_CODEC_BWT || codec == HRLE_CODEC_BWT_ANS || codec == HRLE_CODEC_BWT_CM))) {
+                    used = 1;
+                }
+            }
+            if (!used) continue;
+
+            if (run_case(d, 0, &stages[s], &result, &peak_rss_kb) != 0) result.ok = 0;
+            failures += !result.ok;
+            report(out, "stage", d, stages[s].name, &result, peak_rss_kb);
+        }
+    }
+
+    if (out != stdout) fclose(out);
+    for (int i = 0; i < dataset_count; i++) free(datasets[i].data);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,305 @@
+#include <stdlib.h>
+#include "container.h"
+#include "parallel.h"
+#include "sais.h"
+#include "bwt.h"
+
+// Text position where chain k ends (chain k produces [chain_end(k - 1), chain_end(k)))
+static size_t chain_end(size_t size, uint32_t chains, uint32_t k) {
+    return (uint64_t)size * (k + 1) / chains;
+}
+
+// ----------------- Burrows-Wheeler Transform (BWT) -----------------
+/*
+the suffix array is read twice, in slices spread over the workers: first to
+find the sentinel's row and the chain starts, then to gather the preceding
+bytes, which lands each row at its final stored index
+*/
+#define BWT_SLICES_PER_WORKER 4
+
+typedef struct {
+    const uint8_t *input;
+    uint8_t *output;
+    const int32_t *sa32;  // one of the two is set
+    const int64_t *sa64;
+    size_t size, begin, end;
+    size_t primary;                          // row of text position 0 if in this slice, else 0
+    size_t boundary[BWT_MAX_CHAINS - 1];     // text positions the inverse starts walking from
+    size_t starts[BWT_MAX_CHAINS - 1];       // their rows, if in this slice
+    uint32_t chains;
+} BwtSlice;
+
+static inline size_t sa_at(const BwtSlice *slice, size_t i) {
+    return slice->sa32 ? (size_t)slice->sa32[i] : (size_t)slice->sa64[i];
+}
+
+static void *bwt_find_rows(void *arg) {
+    BwtSlice *slice = arg;
+    for (size_t i = slice->begin; i < slice->end; i++) {
+        size_t pos = sa_at(slice, i);
+        if (pos == 0) slice->primary = i + 1;
+        for (uint32_t k = 0; k + 1 < slice->chains; k++) {
+            if (pos == slice->boundary[k]) slice->starts[k] = i + 1;
+        }
+    }
+    return NULL;
+}
+
+// Row 0 is the sentinel's own rotation, so suffix-array entry i is row i + 1
+static void *bwt_gather(void *arg) {
+    BwtSlice *slice = arg;
+    size_t primary = slice->primary;
+    for (size_t i = slice->begin; i < slice->end; i++) {
+        size_t row = i + 1;
+        if (row == primary) continue;  // preceded by the sentinel, which is not stored
+        slice->output[row - (row > primary)] = slice->input[sa_at(slice, i) - 1];
+    }
+    return NULL;
+}
+
+static int forward_window(const uint8_t *input, uint8_t *output, size_t size, BwtWindow *index) {
+    index->primary = 0;
+    index->chains = size < BWT_CHAIN_MIN_SIZE ? 1 : BWT_MAX_CHAINS;
+    if (size == 0) return CONTAINER_OK;
+    if (size >= BWT_FILTERED) return CONTAINER_ERR_RANGE;  // rows are stored as u32, below both markers
+
+    // 32-bit entries whenever they reach, 64-bit ones only for texts beyond them
+    int wide = size > INT32_MAX;
+    void *sa = malloc(size * (wide ? sizeof(int64_t) : sizeof(int32_t)));
+    if (!sa) return CONTAINER_ERR_MEMORY;
+    int err = wide ? sais_sort64(input, sa, (int64_t)size) : sais_sort32(input, sa, (int32_t)size);
+    if (err) {
+        free(sa);
+        return err;
+    }
+
+    int count = parallel_width() * BWT_SLICES_PER_WORKER;
+    if (size < SAIS_PARALLEL_MIN_SIZE) count = 1;
+    BwtSlice *slices = malloc(count * sizeof(BwtSlice));
+    if (!slices) {
+        free(sa);
+        return CONTAINER_ERR_MEMORY;
+    }
+    for (int t = 0; t < count; t++) {
+        BwtSlice *slice = &slices[t];
+        *slice = (BwtSlice){ .input = input, .output = output, .size = size, .chains = index->chains,
+                             .begin = size * t / count, .end = size * (t + 1) / count };
+        if (wide) slice->sa64 = sa;
+        else slice->sa32 = sa;
+        for (uint32_t k = 0; k + 1 < index->chains; k++) slice->boundary[k] = chain_end(size, index->chains, k);
+    }
+    parallel_run(bwt_find_rows, slices, sizeof(slices[0]), count);
+
+    for (int t = 0; t < count; t++) {
+        if (slices[t].primary) index->primary = slices[t].primary;
+        for (uint32_t k = 0; k + 1 < index->chains; k++) {
+            if (slices[t].starts[k]) index->starts[k] = slices[t].starts[k];
+        }
+    }
+    for (int t = 0; t < count; t++) slices[t].primary = index->primary;
+
+    // Row 0 is the rotation starting at the sentinel, it ends with the last byte
+    output[0] = input[size - 1];
+    parallel_run(bwt_gather, slices, sizeof(slices[0]), count);
+
+    // Rows past the sentinel's are stored one slot earlier
+    for (uint32_t k = 0; k + 1 < index->chains; k++) {
+        if (index->starts[k] >= index->primary) index->starts[k]--;
+    }
+
+    free(slices);
+    free(sa);
+    return CONTAINER_OK;
+}
+
+// ----------------- Inverse BWT -----------------
+/*
+each chain walks backwards from its start, one step per round for every
+chain, so up to BWT_MAX_CHAINS independent loads are in flight; a chain
+ends where the previous one began
+*/
+// Blocks below 2^24 bytes: symbol in the low byte, next stored index above it
+static inline void walk_packed(const uint32_t *t, uint8_t *output, uint32_t *next, size_t *pos, uint32_t chains,
+                               size_t steps) {
+    for (size_t s = 0; s < steps; s++) {
+        for (uint32_t k = 0; k < chains; k++) {
+            uint32_t entry = t[next[k]];
+            output[--pos[k]] = (uint8_t)entry;
+            next[k] = entry >> 8;
+        }
+    }
+}
+
+// Larger blocks: next index and symbol live in separate arrays
+static inline void walk_split(const uint32_t *t, const uint8_t *input, uint8_t *output, uint32_t *next, size_t *pos,
+                              uint32_t chains, size_t steps) {
+    for (size_t s = 0; s < steps; s++) {
+        for (uint32_t k = 0; k < chains; k++) {
+            uint32_t j = next[k];
+            output[--pos[k]] = input[j];
+            next[k] = t[j];
+        }
+    }
+}
+
+static int inverse_window(const uint8_t *input, uint8_t *output, size_t size, const BwtWindow *index) {
+    if (size == 0) return CONTAINER_OK;
+    uint32_t primary = index->primary, chains = index->chains;
+    if (primary == 0 || primary > size || chains == 0 || chains > BWT_MAX_CHAINS || chains > size) {
+        return CONTAINER_ERR_FORMAT;
+    }
+    for (uint32_t k = 0; k + 1 < chains; k++) {
+        if (index->starts[k] >= size) return CONTAINER_ERR_FORMAT;
+    }
+
+    uint32_t *t = malloc(size * sizeof(uint32_t));
+    if (!t) return CONTAINER_ERR_MEMORY;
+
+    // Starting row of each byte value; row 0 belongs to the sentinel
+    uint32_t count[256] = {0};
+    for (size_t i = 0; i < size; i++) count[input[i]]++;
+    uint32_t sum = 1;
+    for (int c = 0; c < 256; c++) {
+        uint32_t temp = count[c];
+        count[c] = sum;
+        sum += temp;
+    }
+
+    // LF mapping, already converted to the stored index of the row it leads to
+    int packed = size < (1u << 24);
+    for (size_t i = 0; i < size; i++) {
+        uint32_t row = count[input[i]]++;
+        uint32_t next = row - (row >= primary);
+        t[i] = packed ? next << 8 | input[i] : next;
+    }
+
+    // The last chain starts at the sentinel row, the others where the forward transform recorded
+    uint32_t next[BWT_MAX_CHAINS];
+    size_t pos[BWT_MAX_CHAINS], begin[BWT_MAX_CHAINS];
+    size_t shortest = size;
+    for (uint32_t k = 0; k < chains; k++) {
+        next[k] = k + 1 < chains ? index->starts[k] : 0;
+        pos[k] = chain_end(size, chains, k);
+        begin[k] = k ? pos[k - 1] : 0;
+        if (pos[k] - begin[k] < shortest) shortest = pos[k] - begin[k];
+    }
+
+    // A constant chain count in the common case lets the compiler keep every chain in registers
+    if (packed && chains == BWT_MAX_CHAINS) walk_packed(t, output, next, pos, BWT_MAX_CHAINS, shortest);
+    else if (packed) walk_packed(t, output, next, pos, chains, shortest);
+    else if (chains == BWT_MAX_CHAINS) walk_split(t, input, output, next, pos, BWT_MAX_CHAINS, shortest);
+    else walk_split(t, input, output, next, pos, chains, shortest);
+
+    // Chains differ in length by at most one step; finish the longer ones
+    for (uint32_t k = 0; k < chains; k++) {
+        if (packed) walk_packed(t, output, &next[k], &pos[k], 1, pos[k] - begin[k]);
+        else walk_split(t, input, output, &next[k], &pos[k], 1, pos[k] - begin[k]);
+    }
+
+    free(t);
+    return CONTAINER_OK;
+}
+
+// ----------------- Windowed Sub-Blocks -----------------
+static size_t configured_window;  // 0 = whole blocks
+
+void bwt_set_window(size_t window) {
+    if (window && window < BWT_WINDOW_MIN_SIZE) window = BWT_WINDOW_MIN_SIZE;
+    __atomic_store_n(&configured_window, window, __ATOMIC_RELAXED);
+}
+
+size_t bwt_window(void) {
+    return __atomic_load_n(&configured_window, __ATOMIC_RELAXED);
+}
+
+// Sub-blocks one after another, so only one window-sized suffix array (or LF table) is alive at a time
+int bwt_forward(const uint8_t *input, uint8_t *output, size_t size, BwtIndex *index) {
+    size_t window = bwt_window();
+    if (window == 0 || size <= window) {
+        index->window = 0;
+        index->count = 1;
+        return forward_window(input, output, size, &index->windows[0]);
+    }
+
+    if ((size + window - 1) / window > BWT_MAX_WINDOWS) window = (size + BWT_MAX_WINDOWS - 1) / BWT_MAX_WINDOWS;
+    if (window >= BWT_WINDOWED) return CONTAINER_ERR_RANGE;
+    index->window = window;
+    index->count = (size + window - 1) / window;
+    for (uint32_t w = 0; w < index->count; w++) {
+        size_t begin = (size_t)w * window, length = size - begin < window ? size - begin : window;
+        int err = forward_window(input + begin, output + begin, length, &index->windows[w]);
+        if (err) return err;
+    }
+    return CONTAINER_OK;
+}
+
+int bwt_inverse(const uint8_t *input, uint8_t *output, size_t size, const BwtIndex *index) {
+    if (index->window == 0) {
+        if (index->count != 1) return CONTAINER_ERR_FORMAT;
+        return inverse_window(input, output, size, &index->windows[0]);
+    }
+
+    if (index->count != (size + index->window - 1) / index->window) return CONTAINER_ERR_FORMAT;
+    for (uint32_t w = 0; w < index->count; w++) {
+        size_t begin = (size_t)w * index->window;
+        size_t length = size - begin < index->window ? size - begin : index->window;
+        int err = inverse_window(input + begin, output + begin, length, &index->windows[w]);
+        if (err) return err;
+    }
+    return CONTAINER_OK;
+}
+
+// ----------------- Index Serialization -----------------
+static size_t store_window(const BwtWindow *index, uint8_t *output) {
+    put_le32(output, index->primary);
+    put_le32(output + 4, index->chains);
+    size_t pos = 8;
+    for (uint32_t k = 0; k + 1 < index->chains; k++, pos += 4) put_le32(output + pos, index->starts[k]);
+    return pos;
+}
+
+static int load_window(const uint8_t *input, size_t input_size, BwtWindow *index, size_t *index_size) {
+    if (input_size < 8) return CONTAINER_ERR_FORMAT;
+    index->primary = get_le32(input);
+    index->chains = get_le32(input + 4);
+    if (index->chains == 0 || index->chains > BWT_MAX_CHAINS) return CONTAINER_ERR_FORMAT;
+
+    *index_size = 8 + 4 * (size_t)(index->chains - 1);
+    if (input_size < *index_size) return CONTAINER_ERR_FORMAT;
+    for (uint32_t k = 0; k + 1 < index->chains; k++) index->starts[k] = get_le32(input + 8 + 4 * k);
+    return CONTAINER_OK;
+}
+
+size_t bwt_store_index(const BwtIndex *index, uint8_t *output) {
+    if (index->window == 0) return store_window(&index->windows[0], output);
+
+    put_le32(output, BWT_WINDOWED);
+    put_le32(output + 4, index->window);
+    put_le32(output + 8, index->count);
+    size_t pos = 12;
+    for (uint32_t w = 0; w < index->count; w++) pos += store_window(&index->windows[w], output + pos);
+    return pos;
+}
+
+int bwt_load_index(const uint8_t *input, size_t input_size, BwtIndex *index, size_t *index_size) {
+    if (input_size < 4) return CONTAINER_ERR_FORMAT;
+    if (get_le32(input) != BWT_WINDOWED) {
+        index->window = 0;
+        index->count = 1;
+        return load_window(input, input_size, &index->windows[0], index_size);
+    }
+
+    if (input_size < 12) return CONTAINER_ERR_FORMAT;
+    index->window = get_le32(input + 4);
+    index->count = get_le32(input + 8);
+    if (index->window == 0 || index->count == 0 || index->count > BWT_MAX_WINDOWS) return CONTAINER_ERR_FORMAT;
+    size_t pos = 12;
+    for (uint32_t w = 0; w < index->count; w++) {
+        size_t window_size;
+        int err = load_window(input + pos, input_size - pos, &index->windows[w], &window_size);
+        if (err) return err;
+        pos += window_size;
+    }
+    *index_size = pos;
+    return CONTAINER_OK;
+}
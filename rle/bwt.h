@@ -0,0 +1,68 @@
+#ifndef BWT_H
+#define BWT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ----------------- Burrows-Wheeler Transform -----------------
+/*
+the end-of-text sentinel is implicit: it sorts before every byte, so inputs
+may contain any byte value (including 0x00); the output holds `size` bytes
+and `primary` records the row the sentinel would have occupied (1..size)
+
+the forward transform also records where evenly spaced text positions ended
+up, so the inverse can walk several LF chains side by side: each step of a
+chain is a dependent cache miss, and independent chains overlap them
+*/
+
+#define BWT_MAX_CHAINS 8
+#define BWT_CHAIN_MIN_SIZE 4096      // smaller blocks use a single chain
+
+typedef struct {
+    uint32_t primary;
+    uint32_t chains;                        // 1..BWT_MAX_CHAINS
+    uint32_t starts[BWT_MAX_CHAINS - 1];    // stored index of text position (k + 1) * size / chains
+} BwtWindow;
+
+// ----------------- Windowed Sub-Blocks -----------------
+/*
+with a window set, larger blocks are cut into consecutive sub-blocks of
+that many bytes, each transformed as its own BWT with its own rows: not a
+BWT of the whole block, since contexts no longer reach across sub-blocks
+and compression falls toward that of window-sized blocks. Only the suffix
+array (and the inverse's LF table) shrinks, from 4 * size to 4 * window;
+the input, output and the codec pipeline's buffers stay block-sized, see
+hrle_set_bwt_window for the resulting peaks
+
+a block never splits into more than BWT_MAX_WINDOWS sub-blocks, they grow
+instead; the setting is process-wide like the thread count, and decoding
+follows whatever each block's index says
+*/
+#define BWT_MAX_WINDOWS 64
+#define BWT_WINDOW_MIN_SIZE (64u << 10)
+#define BWT_WINDOWED 0xFFFFFFFFu  // stored in place of primary, which never reaches it
+#define BWT_FILTERED 0xFFFFFFFEu  // never stored either, codecs.c marks filtered payloads with it
+
+void bwt_set_window(size_t window);  // 0 (the default) transforms whole blocks
+size_t bwt_window(void);
+
+typedef struct {
+    uint32_t window;   // bytes per window, 0 when the block is one transform
+    uint32_t count;    // windows, 1..BWT_MAX_WINDOWS
+    BwtWindow windows[BWT_MAX_WINDOWS];
+} BwtIndex;
+
+#define BWT_WINDOW_MAX_SIZE (8 + 4 * (BWT_MAX_CHAINS - 1))
+#define BWT_INDEX_MAX_SIZE (12 + BWT_MAX_WINDOWS * BWT_WINDOW_MAX_SIZE)
+
+int bwt_forward(const uint8_t *input, uint8_t *output, size_t size, BwtIndex *index);
+int bwt_inverse(const uint8_t *input, uint8_t *output, size_t size, const BwtIndex *index);
+
+/*
+serialized index: primary, chains, starts (u32 little-endian each); a
+windowed block stores BWT_WINDOWED, window, count, then that for every window
+*/
+size_t bwt_store_index(const BwtIndex *index, uint8_t *output);
+int bwt_load_index(const uint8_t *input, size_t input_size, BwtIndex *index, size_t *index_size);
+
+#endif
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <string.h>
+#include "container.h"
+#include "cm.h"
+
+#define CM_PROB_MAX ((1 << CM_PROB_BITS) - 1)
+#define CM_ORDER0_SHIFT 4  // order 0 moves 1/16 of the way to every bit it sees
+#define CM_ORDER1_SHIFT 6  // order 1 sees fewer bits per context, and settles more slowly
+#define CM_MIX_SHIFT 12    // mixer learning rate
+#define CM_WEIGHT_ONE 65536
+
+// ----------------- Logistic Domain -----------------
+// squash(x) = 4096 / (1 + e^-(x / 256)), interpolated from 33 points; stretch is its inverse
+static int squash(int x) {
+    static const int points[33] = {
+        1, 2, 3, 6, 10, 16, 27, 45, 73, 120, 194, 310, 488, 747, 1101, 1546, 2047,
+        2549, 2994, 3348, 3607, 3785, 3901, 3975, 4022, 4050, 4068, 4079, 4085, 4089, 4092, 4093, 4094
+    };
+    if (x > 2047) return CM_PROB_MAX;
+    if (x < -2047) return 1;
+    int w = x & 127;
+    int i = (x >> 7) + 16;
+    return (points[i] * (128 - w) + points[i + 1] * w + 64) >> 7;
+}
+
+// ----------------- Model -----------------
+typedef struct {
+    uint16_t order0[CM_NODES];               // P(bit = 1) of every decision
+    uint16_t order1[CM_CONTEXTS][CM_NODES];  // the same, per previous-rank context
+    int32_t weights[CM_CONTEXTS][CM_NODES][2];
+    int16_t stretch[CM_PROB_MAX + 1];
+    int context;
+    uint32_t run;  // zeros in a row so far
+
+    // The decision being coded
+    uint16_t *p0, *p1;
+    int32_t *w;
+    int s0, s1, p;
+} CmModel;
+
+static CmModel *model_create(void) {
+    CmModel *model = malloc(sizeof(*model));
+    if (!model) return NULL;
+    for (int i = 0; i < CM_NODES; i++) model->order0[i] = 1 << (CM_PROB_BITS - 1);
+    for (int c = 0; c < CM_CONTEXTS; c++) {
+        for (int i = 0; i < CM_NODES; i++) {
+            model->order1[c][i] = 1 << (CM_PROB_BITS - 1);
+            model->weights[c][i][0] = CM_WEIGHT_ONE / 2;
+            model->weights[c][i][1] = CM_WEIGHT_ONE / 2;
+        }
+    }
+
+    int next = 0;
+    for (int x = -2047; x <= 2047; x++) {
+        int p = squash(x);
+        while (next <= p) model->stretch[next++] = x;
+    }
+    while (next <= CM_PROB_MAX) model->stretch[next++] = 2047;
+
+    model->context = 0;
+    model->run = 0;
+    return model;
+}
+
+static inline int model_predict(CmModel *model, int node) {
+    model->p0 = &model->order0[node];
+    model->p1 = &model->order1[model->context][node];
+    model->w = model->weights[model->context][node];
+    model->s0 = model->stretch[*model->p0];
+    model->s1 = model->stretch[*model->p1];
+
+    int p = squash((int)(((int64_t)model->w[0] * model->s0 + (int64_t)model->w[1] * model->s1) >> 16));
+    if (p < 1) p = 1;
+    if (p > CM_PROB_MAX) p = CM_PROB_MAX;
+    model->p = p;
+    return p;
+}
+
+static inline void model_update(CmModel *model, int bit) {
+    int err = (bit << CM_PROB_BITS) - model->p;
+    model->w[0] += (model->s0 * err) >> CM_MIX_SHIFT;
+    model->w[1] += (model->s1 * err) >> CM_MIX_SHIFT;
+
+    int target = bit ? CM_PROB_MAX : 0;
+    *model->p0 += (target - *model->p0) >> CM_ORDER0_SHIFT;
+    *model->p1 += (target - *model->p1) >> CM_ORDER1_SHIFT;
+}
+
+// The context of the next rank: the current zero run, or the highest bit of a nonzero rank
+static inline void model_next(CmModel *model, int rank, int highest) {
+    if (rank == 0) {
+        model->run++;
+        model->context = model->run == 1 ? 0 : model->run <= 3 ? 1 : 2;
+    } else {
+        model->run = 0;
+        model->context = 3 + highest;
+    }
+}
+
+// Decision nodes: 0 is rank != 0, 1 + j is "highest bit above j", then a binary tree of the bits below it
+#define NODE_NONZERO 0
+#define NODE_UNARY 1
+#define NODE_TREE(highest, prefix) (16 + (highest) * 128 + (prefix))
+
+// ----------------- Binary Arithmetic Coder -----------------
+/*
+the interval [low, high] is split in proportion to P(bit = 1); once the top
+byte of both ends agrees it can never change again and is shifted out
+*/
+typedef struct {
+    uint32_t low, high;
+    uint8_t *ptr, *end;
+    int overflow;  // ran out of room; the caller stores the input instead
+} CmEncoder;
+
+static inline void encode_bit(CmEncoder *enc, int bit, int p) {
+    uint32_t mid = enc->low + (uint32_t)(((uint64_t)(enc->high - enc->low) * p) >> CM_PROB_BITS);
+    if (bit) enc->high = mid;
+    else enc->low = mid + 1;
+    while (((enc->low ^ enc->high) & 0xff000000u) == 0) {
+        if (enc->ptr < enc->end) *enc->ptr++ = enc->high >> 24;
+        else enc->overflow = 1;
+        enc->low <<= 8;
+        enc->high = (enc->high << 8) | 255;
+    }
+}
+
+typedef struct {
+    uint32_t low, high, x;
+    const uint8_t *ptr, *end;
+    int overrun;  // read past the end of the input
+} CmDecoder;
+
+static inline uint8_t decoder_byte(CmDecoder *dec) {
+    if (dec->ptr < dec->end) return *dec->ptr++;
+    dec->overrun = 1;
+    return 0;
+}
+
+static inline int decode_bit(CmDecoder *dec, int p) {
+    uint32_t mid = dec->low + (uint32_t)(((uint64_t)(dec->high - dec->low) * p) >> CM_PROB_BITS);
+    int bit = dec->x <= mid;
+    if (bit) dec->high = mid;
+    else dec->low = mid + 1;
+    while (((dec->low ^ dec->high) & 0xff000000u) == 0) {
+        dec->low <<= 8;
+        dec->high = (dec->high << 8) | 255;
+        dec->x = (dec->x << 8) | decoder_byte(dec);
+    }
+    return bit;
+}
+
+// ----------------- Ranks -----------------
+static inline void encode_rank(CmModel *model, CmEncoder *enc, int rank) {
+    int bit = rank != 0;
+    encode_bit(enc, bit, model_predict(model, NODE_NONZERO));
+    model_update(model, bit);
+    if (!rank) {
+        model_next(model, 0, 0);
+        return;
+    }
+
+    int highest = 31 - __builtin_clz(rank);
+    for (int j = 0; j < 7; j++) {
+        bit = j < highest;
+        encode_bit(enc, bit, model_predict(model, NODE_UNARY + j));
+        model_update(model, bit);
+        if (!bit) break;
+    }
+
+    int prefix = 1;
+    for (int j = highest - 1; j >= 0; j--) {
+        bit = (rank >> j) & 1;
+        encode_bit(enc, bit, model_predict(model, NODE_TREE(highest, prefix)));
+        model_update(model, bit);
+        prefix = prefix * 2 + bit;
+    }
+    model_next(model, rank, highest);
+}
+
+static inline int decode_rank(CmModel *model, CmDecoder *dec) {
+    int bit = decode_bit(dec, model_predict(model, NODE_NONZERO));
+    model_update(model, bit);
+    if (!bit) {
+        model_next(model, 0, 0);
+        return 0;
+    }
+
+    int highest = 0;
+    while (highest < 7) {
+        bit = decode_bit(dec, model_predict(model, NODE_UNARY + highest));
+        model_update(model, bit);
+        if (!bit) break;
+        highest++;
+    }
+
+    int prefix = 1;
+    for (int j = highest - 1; j >= 0; j--) {
+        bit = decode_bit(dec, model_predict(model, NODE_TREE(highest, prefix)));
+        model_update(model, bit);
+        prefix = prefix * 2 + bit;
+    }
+    model_next(model, prefix, highest);
+    return prefix;
+}
+
+// ----------------- Compression -----------------
+size_t cm_compress_bound(size_t size) {
+    return 1 + size;
+}
+
+int cm_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    CmModel *model = model_create();
+    if (!model) return CONTAINER_ERR_MEMORY;
+
+    // Coding only pays off below the input's own size, which is also the most it may take
+    CmEncoder enc = { .low = 0, .high = 0xffffffffu, .ptr = output + 1, .end = output + 1 + size, .overflow = 0 };
+    for (size_t i = 0; i < size && !enc.overflow; i++) encode_rank(model, &enc, input[i]);
+    for (int i = 0; i < 4 && !enc.overflow; i++) {
+        if (enc.ptr < enc.end) *enc.ptr++ = enc.low >> (24 - 8 * i);
+        else enc.overflow = 1;
+    }
+    free(model);
+
+    if (enc.overflow || (size_t)(enc.ptr - output - 1) >= size) {
+        output[0] = CM_MODE_STORED;
+        memcpy(output + 1, input, size);
+        *output_size = 1 + size;
+    } else {
+        output[0] = CM_MODE_CODED;
+        *output_size = enc.ptr - output;
+    }
+    return CONTAINER_OK;
+}
+
+int cm_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    if (input_size < 1) return CONTAINER_ERR_FORMAT;
+    if (input[0] == CM_MODE_STORED) {
+        if (input_size - 1 != size) return CONTAINER_ERR_FORMAT;
+        memcpy(output, input + 1, size);
+        return CONTAINER_OK;
+    }
+    if (input[0] != CM_MODE_CODED) return CONTAINER_ERR_FORMAT;
+
+    CmModel *model = model_create();
+    if (!model) return CONTAINER_ERR_MEMORY;
+
+    CmDecoder dec = { .low = 0, .high = 0xffffffffu, .x = 0, .ptr = input + 1, .end = input + input_size, .overrun = 0 };
+    for (int i = 0; i < 4; i++) dec.x = (dec.x << 8) | decoder_byte(&dec);
+    for (size_t i = 0; i < size; i++) output[i] = decode_rank(model, &dec);
+    free(model);
+
+    // The encoder's bytes are exactly the ones shifted in, the last four being its final low end
+    if (dec.overrun || dec.ptr != dec.end) return CONTAINER_ERR_FORMAT;
+    return CONTAINER_OK;
+}
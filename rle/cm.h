@@ -0,0 +1,30 @@
+#ifndef CM_H
+#define CM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ----------------- Context-Mixing Rank Coder -----------------
+/*
+adaptive binary arithmetic coding of MTF ranks for maximum ratio: each rank
+is split into binary decisions (is it zero, the unary length of its
+highest set bit, then the bits below it), every decision is predicted by an
+order-0 model and an order-1 model keyed on the previous rank and the
+current zero run, and a logistic mixer combines the two
+
+payload: a mode byte, then either the arithmetic-coded stream
+(CM_MODE_CODED) or the input as is (CM_MODE_STORED), which the encoder
+falls back to when coding would not fit in the input's size
+*/
+#define CM_MODE_STORED 0
+#define CM_MODE_CODED 1
+
+#define CM_PROB_BITS 12
+#define CM_NODES 1040    // binary decisions per rank: zero flag, 8 unary, 8 trees of up to 128
+#define CM_CONTEXTS 11   // previous rank: zero (by run length 1, 2-3, 4+) or its highest bit (1..8)
+
+size_t cm_compress_bound(size_t size);
+int cm_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size);
+int cm_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+#endif
@@ -0,0 +1,493 @@
+#include <stdlib.h>
+#include "stream.h"
+#include "huffman.h"
+#include "ans.h"
+#include "cm.h"
+#include "rle.h"
+#include "mtf.h"
+#include "bwt.h"
+#include "filter.h"
+
+// Huffman or rANS, whichever suits the block (Entropy Coder Choice below)
+static size_t entropy_bound(size_t size);
+static int entropy_compress_select(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size,
+                                   uint8_t *id);
+
+// ----------------- Huffman -----------------
+static const StreamCodec huffman_codec = {
+    .id = CONTAINER_CODEC_HUFFMAN,
+    .bound = entropy_bound,
+    .compress = huffman_compress,
+    .decompress = huffman_decompress,
+    .compress_select = entropy_compress_select
+};
+
+// ----------------- Interleaved Huffman -----------------
+static const StreamCodec huffman_x4_codec = {
+    .id = CONTAINER_CODEC_HUFFMAN_X4,
+    .bound = huffman_x4_bound,
+    .compress = huffman_x4_compress,
+    .decompress = huffman_x4_decompress
+};
+
+static int huffman_x16_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    return huffman_gather_compress(input, size, output, output_size, HUFF_GATHER_MAX_STREAMS);
+}
+
+static const StreamCodec huffman_x16_codec = {
+    .id = CONTAINER_CODEC_HUFFMAN_X16,
+    .bound = huffman_gather_bound,
+    .compress = huffman_x16_compress,
+    .decompress = huffman_gather_decompress
+};
+
+// ----------------- SIMD Block RLE -----------------
+static const StreamCodec block_rle_codec = {
+    .id = CONTAINER_CODEC_BLOCK_RLE,
+    .bound = block_rle_chunked_bound,
+    .compress = block_rle_compress_chunked,
+    .decompress = block_rle_decompress_chunked
+};
+
+// ----------------- Byte RLE -----------------
+static int byte_rle_codec_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    *output_size = byte_rle_compress(input, size, output);
+    return CONTAINER_OK;
+}
+
+static const StreamCodec byte_rle_codec = {
+    .id = CONTAINER_CODEC_BYTE_RLE,
+    .bound = byte_rle_bound,
+    .compress = byte_rle_codec_compress,
+    .decompress = byte_rle_decompress
+};
+
+// ----------------- rANS -----------------
+static const StreamCodec ans_codec = {
+    .id = CONTAINER_CODEC_ANS,
+    .bound = entropy_bound,
+    .compress = ans_compress,
+    .decompress = ans_decompress,
+    .compress_select = entropy_compress_select
+};
+
+// ----------------- Entropy Coder Choice -----------------
+static int configured_entropy = STREAM_ENTROPY_FIXED;
+
+void stream_set_entropy(int mode) {
+    if (mode != STREAM_ENTROPY_AUTO) mode = STREAM_ENTROPY_FIXED;
+    __atomic_store_n(&configured_entropy, mode, __ATOMIC_RELAXED);
+}
+
+int stream_entropy(void) {
+    return __atomic_load_n(&configured_entropy, __ATOMIC_RELAXED);
+}
+
+// Both variants of a codec share this bound, so a payload slot sized for one holds the other
+static size_t entropy_bound(size_t size) {
+    size_t huffman = huffman_compress_bound(size), ans = ans_compress_bound(size);
+    return huffman > ans ? huffman : ans;
+}
+
+/*
+the coder that codes data smaller, estimated from its histogram: Huffman at
+the code lengths huffman_compress would build, rANS at -log2 of the
+normalized probabilities, each plus its header. Huffman loses up to a bit
+per symbol on skewed data and rANS spends more on its table, so neither
+wins every block
+*/
+static const StreamCodec *cheaper_entropy(const uint8_t *data, size_t size) {
+    uint32_t freq[256], normalized[256];
+    uint8_t lengths[256];
+    if (!size) return &huffman_codec;
+    count_frequencies(data, size, freq);
+    compute_code_lengths(freq, lengths, HUFF_MAX_CODE_LEN);
+    ans_normalize(freq, normalized);
+
+    uint64_t huffman_bits = 0, ans_cost = 0;  // ans_cost in 1/256 bits
+    size_t symbols = 0;
+    for (int c = 0; c < 256; c++) {
+        if (!freq[c]) continue;
+        symbols++;
+        huffman_bits += (uint64_t)freq[c] * lengths[c];
+        ans_cost += (uint64_t)freq[c] * (ANS_PROB_BITS * 256 - log2_fixed(normalized[c]));
+    }
+    size_t huffman_size = HUFF_HEADER_SIZE + 4 + 8 * HUFF_THREADS + huffman_bits / 8;
+    size_t ans_size = ANS_HEADER_MAX_SIZE - 2 * (256 - symbols) + ans_cost / (8 * 256);
+    return ans_size < huffman_size ? &ans_codec : &huffman_codec;
+}
+
+static int entropy_compress_select(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size,
+                                   uint8_t *id) {
+    const StreamCodec *entropy = cheaper_entropy(input, size);
+    *id = entropy->id;
+    return entropy->compress(input, size, output, output_size);
+}
+
+// ----------------- MTF + Entropy Coder -----------------
+/*
+the pipelines below end in Huffman or rANS: `*entropy` is huffman_codec or
+ans_codec, or NULL to pick per block with cheaper_entropy, which then sets it
+*/
+static int mtf_entropy_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size,
+                                const StreamCodec **entropy) {
+    uint8_t *mtf_data = malloc(size ? size : 1);
+    if (!mtf_data) return CONTAINER_ERR_MEMORY;
+
+    mtf_encode(input, mtf_data, size);
+    if (!*entropy) *entropy = cheaper_entropy(mtf_data, size);
+    int err = (*entropy)->compress(mtf_data, size, output, output_size);
+    free(mtf_data);
+    return err;
+}
+
+static int mtf_entropy_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size,
+                                  const StreamCodec *entropy) {
+    uint8_t *mtf_data = malloc(size ? size : 1);
+    if (!mtf_data) return CONTAINER_ERR_MEMORY;
+
+    int err = entropy->decompress(input, input_size, mtf_data, size);
+    if (!err) mtf_decode(mtf_data, output, size);
+    free(mtf_data);
+    return err;
+}
+
+static int mtf_huffman_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    const StreamCodec *entropy = &huffman_codec;
+    return mtf_entropy_compress(input, size, output, output_size, &entropy);
+}
+
+static int mtf_huffman_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    return mtf_entropy_decompress(input, input_size, output, size, &huffman_codec);
+}
+
+static int mtf_compress_select(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size,
+                               uint8_t *id) {
+    const StreamCodec *entropy = NULL;
+    int err = mtf_entropy_compress(input, size, output, output_size, &entropy);
+    *id = entropy == &ans_codec ? CONTAINER_CODEC_MTF_ANS : CONTAINER_CODEC_MTF_HUFFMAN;
+    return err;
+}
+
+static const StreamCodec mtf_huffman_codec = {
+    .id = CONTAINER_CODEC_MTF_HUFFMAN,
+    .bound = entropy_bound,
+    .compress = mtf_huffman_compress,
+    .decompress = mtf_huffman_decompress,
+    .compress_select = mtf_compress_select
+};
+
+static int mtf_ans_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    const StreamCodec *entropy = &ans_codec;
+    return mtf_entropy_compress(input, size, output, output_size, &entropy);
+}
+
+static int mtf_ans_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    return mtf_entropy_decompress(input, input_size, output, size, &ans_codec);
+}
+
+static const StreamCodec mtf_ans_codec = {
+    .id = CONTAINER_CODEC_MTF_ANS,
+    .bound = entropy_bound,
+    .compress = mtf_ans_compress,
+    .decompress = mtf_ans_decompress,
+    .compress_select = mtf_compress_select
+};
+
+// ----------------- BWT + MTF + Zero-Run + Entropy Coder -----------------
+/*
+payload: BWT index (bwt_store_index), zero-run coded size (u32 little-endian),
+then the Huffman or rANS payload of the zero-run coded MTF output
+*/
+static size_t bwt_pipeline_bound(size_t size) {
+    return BWT_INDEX_MAX_SIZE + 4 + entropy_bound(zero_rle_bound(size));
+}
+
+static int bwt_entropy_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size,
+                                const StreamCodec **entropy) {
+    uint8_t *bwt_data = malloc(size ? size : 1);
+    uint8_t *run_data = malloc(size ? zero_rle_bound(size) : 1);
+    int err = bwt_data && run_data ? CONTAINER_OK : CONTAINER_ERR_MEMORY;
+
+    BwtIndex index;
+    if (!err) err = bwt_forward(input, bwt_data, size, &index);
+    if (!err) {
+        mtf_encode(bwt_data, bwt_data, size);
+        size_t run_size = zero_rle_encode(bwt_data, size, run_data);
+
+        size_t header_size = bwt_store_index(&index, output);
+        put_le32(output + header_size, run_size);
+        header_size += 4;
+        if (!*entropy) *entropy = cheaper_entropy(run_data, run_size);
+        err = (*entropy)->compress(run_data, run_size, output + header_size, output_size);
+        *output_size += header_size;
+    }
+
+    free(run_data);
+    free(bwt_data);
+    return err;
+}
+
+static int bwt_entropy_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size,
+                                  const StreamCodec *entropy) {
+    BwtIndex index;
+    size_t index_size;
+    int err = bwt_load_index(input, input_size, &index, &index_size);
+    if (err) return err;
+    if (input_size - index_size < 4) return CONTAINER_ERR_FORMAT;
+    size_t run_size = get_le32(input + index_size);
+    if (run_size > zero_rle_bound(size)) return CONTAINER_ERR_FORMAT;
+    input += index_size + 4;
+    input_size -= index_size + 4;
+
+    uint8_t *run_data = malloc(run_size ? run_size : 1);
+    uint8_t *bwt_data = malloc(size ? size : 1);
+    err = run_data && bwt_data ? CONTAINER_OK : CONTAINER_ERR_MEMORY;
+
+    if (!err) err = entropy->decompress(input, input_size, run_data, run_size);
+    if (!err) err = zero_rle_decode(run_data, run_size, bwt_data, size);
+    if (!err) {
+        mtf_decode(bwt_data, bwt_data, size);
+        err = bwt_inverse(bwt_data, output, size, &index);
+    }
+
+    free(bwt_data);
+    free(run_data);
+    return err;
+}
+
+static int bwt_pipeline_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    const StreamCodec *entropy = &huffman_codec;
+    return bwt_entropy_compress(input, size, output, output_size, &entropy);
+}
+
+static int bwt_pipeline_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    return bwt_entropy_decompress(input, input_size, output, size, &huffman_codec);
+}
+
+static int bwt_pipeline_compress_select(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size,
+                                        uint8_t *id) {
+    const StreamCodec *entropy = NULL;
+    int err = bwt_entropy_compress(input, size, output, output_size, &entropy);
+    *id = entropy == &ans_codec ? CONTAINER_CODEC_BWT_ANS : CONTAINER_CODEC_BWT;
+    return err;
+}
+
+static const StreamCodec bwt_pipeline = {
+    .id = CONTAINER_CODEC_BWT,
+    .bound = bwt_pipeline_bound,
+    .compress = bwt_pipeline_compress,
+    .decompress = bwt_pipeline_decompress,
+    .compress_select = bwt_pipeline_compress_select
+};
+
+static int bwt_ans_pipeline_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    const StreamCodec *entropy = &ans_codec;
+    return bwt_entropy_compress(input, size, output, output_size, &entropy);
+}
+
+static int bwt_ans_pipeline_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    return bwt_entropy_decompress(input, input_size, output, size, &ans_codec);
+}
+
+static const StreamCodec bwt_ans_pipeline = {
+    .id = CONTAINER_CODEC_BWT_ANS,
+    .bound = bwt_pipeline_bound,
+    .compress = bwt_ans_pipeline_compress,
+    .decompress = bwt_ans_pipeline_decompress,
+    .compress_select = bwt_pipeline_compress_select
+};
+
+// ----------------- BWT + MTF + Context Mixing -----------------
+/*
+payload: BWT index (bwt_store_index), then the cm.c payload of the MTF
+output; there is no zero-run stage, the coder's zero-run contexts model
+runs of rank 0 better than run lengths would
+*/
+static size_t bwt_cm_pipeline_bound(size_t size) {
+    return BWT_INDEX_MAX_SIZE + cm_compress_bound(size);
+}
+
+static int bwt_cm_pipeline_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    uint8_t *bwt_data = malloc(size ? size : 1);
+    if (!bwt_data) return CONTAINER_ERR_MEMORY;
+
+    BwtIndex index;
+    int err = bwt_forward(input, bwt_data, size, &index);
+    if (!err) {
+        mtf_encode(bwt_data, bwt_data, size);
+        size_t header_size = bwt_store_index(&index, output);
+        err = cm_compress(bwt_data, size, output + header_size, output_size);
+        *output_size += header_size;
+    }
+
+    free(bwt_data);
+    return err;
+}
+
+static int bwt_cm_pipeline_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    BwtIndex index;
+    size_t index_size;
+    int err = bwt_load_index(input, input_size, &index, &index_size);
+    if (err) return err;
+
+    uint8_t *bwt_data = malloc(size ? size : 1);
+    if (!bwt_data) return CONTAINER_ERR_MEMORY;
+
+    err = cm_decompress(input + index_size, input_size - index_size, bwt_data, size);
+    if (!err) {
+        mtf_decode(bwt_data, bwt_data, size);
+        err = bwt_inverse(bwt_data, output, size, &index);
+    }
+
+    free(bwt_data);
+    return err;
+}
+
+static const StreamCodec bwt_cm_pipeline = {
+    .id = CONTAINER_CODEC_BWT_CM,
+    .bound = bwt_cm_pipeline_bound,
+    .compress = bwt_cm_pipeline_compress,
+    .decompress = bwt_cm_pipeline_decompress
+};
+
+// ----------------- Pre-BWT Filters -----------------
+/*
+the bwt codecs run each block through the filter filter.c selects for it
+first, if any; a filtered block's payload starts with BWT_FILTERED, the
+filter id (u8), its parameter and the filtered size (u32 little-endian),
+then continues as the pipeline's payload of the filtered bytes. Unfiltered
+blocks carry the pipeline's payload alone, which never starts that way
+*/
+#define FILTER_HEADER_SIZE 13
+
+static size_t filtered_bound(const StreamCodec *pipeline, size_t size) {
+    return FILTER_HEADER_SIZE + pipeline->bound(filter_bound(size));
+}
+
+// Codes with the pipeline as it is, or with its compress_select when `id` is given
+static int pipeline_compress(const StreamCodec *pipeline, const uint8_t *input, size_t size, uint8_t *output,
+                             size_t *output_size, uint8_t *id) {
+    return id ? pipeline->compress_select(input, size, output, output_size, id)
+              : pipeline->compress(input, size, output, output_size);
+}
+
+static int filtered_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size,
+                             const StreamCodec *pipeline, uint8_t *id) {
+    uint32_t param;
+    const Filter *filter = filter_select(input, size, &param);
+    if (!filter) return pipeline_compress(pipeline, input, size, output, output_size, id);
+
+    uint8_t *filtered = malloc(filter->bound(size));
+    if (!filtered) return CONTAINER_ERR_MEMORY;
+    size_t filtered_size;
+    int err = filter->forward(input, size, param, filtered, &filtered_size);
+    if (!err) {
+        put_le32(output, BWT_FILTERED);
+        output[4] = filter->id;
+        put_le32(output + 5, param);
+        put_le32(output + 9, filtered_size);
+        err = pipeline_compress(pipeline, filtered, filtered_size, output + FILTER_HEADER_SIZE, output_size, id);
+        *output_size += FILTER_HEADER_SIZE;
+    }
+
+    free(filtered);
+    return err;
+}
+
+static int filtered_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size,
+                               const StreamCodec *pipeline) {
+    if (input_size < 4 || get_le32(input) != BWT_FILTERED) return pipeline->decompress(input, input_size, output, size);
+    if (input_size < FILTER_HEADER_SIZE) return CONTAINER_ERR_FORMAT;
+    const Filter *filter = filter_get(input[4]);
+    uint32_t param = get_le32(input + 5);
+    size_t filtered_size = get_le32(input + 9);
+    if (!filter || filtered_size > filter->bound(size)) return CONTAINER_ERR_FORMAT;
+
+    uint8_t *filtered = malloc(filtered_size ? filtered_size : 1);
+    if (!filtered) return CONTAINER_ERR_MEMORY;
+    int err = pipeline->decompress(input + FILTER_HEADER_SIZE, input_size - FILTER_HEADER_SIZE, filtered, filtered_size);
+    if (!err) err = filter->inverse(filtered, filtered_size, param, output, size);
+
+    free(filtered);
+    return err;
+}
+
+static size_t bwt_bound(size_t size) {
+    return filtered_bound(&bwt_pipeline, size);
+}
+
+static int bwt_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    return filtered_compress(input, size, output, output_size, &bwt_pipeline, NULL);
+}
+
+static int bwt_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    return filtered_decompress(input, input_size, output, size, &bwt_pipeline);
+}
+
+// Either bwt codec: the pipeline picks Huffman or rANS per block, so bwt_pipeline stands for both
+static int bwt_compress_select(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size,
+                               uint8_t *id) {
+    return filtered_compress(input, size, output, output_size, &bwt_pipeline, id);
+}
+
+static const StreamCodec bwt_codec = {
+    .id = CONTAINER_CODEC_BWT,
+    .bound = bwt_bound,
+    .compress = bwt_compress,
+    .decompress = bwt_decompress,
+    .compress_select = bwt_compress_select
+};
+
+static int bwt_ans_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    return filtered_compress(input, size, output, output_size, &bwt_ans_pipeline, NULL);
+}
+
+static int bwt_ans_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    return filtered_decompress(input, input_size, output, size, &bwt_ans_pipeline);
+}
+
+static const StreamCodec bwt_ans_codec = {
+    .id = CONTAINER_CODEC_BWT_ANS,
+    .bound = bwt_bound,
+    .compress = bwt_ans_compress,
+    .decompress = bwt_ans_decompress,
+    .compress_select = bwt_compress_select
+};
+
+static size_t bwt_cm_bound(size_t size) {
+    return filtered_bound(&bwt_cm_pipeline, size);
+}
+
+static int bwt_cm_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    return filtered_compress(input, size, output, output_size, &bwt_cm_pipeline, NULL);
+}
+
+static int bwt_cm_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    return filtered_decompress(input, input_size, output, size, &bwt_cm_pipeline);
+}
+
+static const StreamCodec bwt_cm_codec = {
+    .id = CONTAINER_CODEC_BWT_CM,
+    .bound = bwt_cm_bound,
+    .compress = bwt_cm_compress,
+    .decompress = bwt_cm_decompress
+};
+
+// ----------------- Registry -----------------
+const StreamCodec *stream_codec(uint8_t id) {
+    switch (id) {
+        case CONTAINER_CODEC_HUFFMAN: return &huffman_codec;
+        case CONTAINER_CODEC_BLOCK_RLE: return &block_rle_codec;
+        case CONTAINER_CODEC_BYTE_RLE: return &byte_rle_codec;
+        case CONTAINER_CODEC_MTF_HUFFMAN: return &mtf_huffman_codec;
+        case CONTAINER_CODEC_BWT: return &bwt_codec;
+        case CONTAINER_CODEC_HUFFMAN_X4: return &huffman_x4_codec;
+        case CONTAINER_CODEC_HUFFMAN_X16: return &huffman_x16_codec;
+        case CONTAINER_CODEC_ANS: return &ans_codec;
+        case CONTAINER_CODEC_MTF_ANS: return &mtf_ans_codec;
+        case CONTAINER_CODEC_BWT_ANS: return &bwt_ans_codec;
+        case CONTAINER_CODEC_BWT_CM: return &bwt_cm_codec;
+        default: return NULL;
+    }
+}
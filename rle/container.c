@@ -0,0 +1,285 @@
+#include <stdlib.h>
+#include <string.h>
+#include "container.h"
+
+// ----------------- CRC-32 -----------------
+// IEEE polynomial, reflected; the tables are filled before main() so threads can share them
+/*
+slicing-by-8: crc_table[t][b] is the CRC of byte b followed by t zero
+bytes, so eight input bytes fold into the CRC with eight independent
+lookups instead of a chain of eight dependent ones
+*/
+static uint32_t crc_table[8][256];
+
+__attribute__((constructor)) static void crc32_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[0][i] = c;
+    }
+    for (int t = 1; t < 8; t++) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = crc_table[t - 1][i];
+            crc_table[t][i] = crc_table[0][c & 0xFF] ^ (c >> 8);
+        }
+    }
+}
+
+uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t size) {
+    crc = ~crc;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint32_t lo = get_le32(data + i) ^ crc, hi = get_le32(data + i + 4);
+        crc = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^
+              crc_table[5][(lo >> 16) & 0xFF] ^ crc_table[4][lo >> 24] ^
+              crc_table[3][hi & 0xFF] ^ crc_table[2][(hi >> 8) & 0xFF] ^
+              crc_table[1][(hi >> 16) & 0xFF] ^ crc_table[0][hi >> 24];
+    }
+    for (; i < size; i++) crc = crc_table[0][(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// ----------------- Serialization -----------------
+void container_put_file_header(uint8_t out[CONTAINER_FILE_HEADER_SIZE], uint32_t block_size) {
+    memcpy(out, CONTAINER_MAGIC, 4);
+    out[4] = CONTAINER_VERSION;
+    out[5] = 0;  // flags
+    put_le16(out + 6, 0);
+    put_le32(out + 8, block_size);
+    put_le32(out + 12, 0);
+}
+
+int container_get_file_header(const uint8_t in[CONTAINER_FILE_HEADER_SIZE], uint32_t *block_size) {
+    if (memcmp(in, CONTAINER_MAGIC, 4) != 0 || in[4] != CONTAINER_VERSION) return CONTAINER_ERR_FORMAT;
+    *block_size = get_le32(in + 8);
+    if (*block_size == 0 || *block_size > CONTAINER_MAX_BLOCK_SIZE) return CONTAINER_ERR_FORMAT;
+    return CONTAINER_OK;
+}
+
+void container_put_block_header(uint8_t out[CONTAINER_BLOCK_HEADER_SIZE], const ContainerBlockHeader *header) {
+    out[0] = header->codec;
+    out[1] = header->flags;
+    put_le16(out + 2, 0);
+    put_le32(out + 4, header->raw_size);
+    put_le32(out + 8, header->payload_size);
+    put_le32(out + 12, header->checksum);
+}
+
+int container_get_block_header(const uint8_t in[CONTAINER_BLOCK_HEADER_SIZE], ContainerBlockHeader *header) {
+    header->codec = in[0];
+    header->flags = in[1];
+    header->raw_size = get_le32(in + 4);
+    header->payload_size = get_le32(in + 8);
+    header->checksum = get_le32(in + 12);
+    if (header->codec == CONTAINER_CODEC_END) {
+        return (header->raw_size || header->payload_size) ? CONTAINER_ERR_FORMAT : CONTAINER_OK;
+    }
+    if (header->raw_size > CONTAINER_MAX_BLOCK_SIZE) return CONTAINER_ERR_FORMAT;
+    return CONTAINER_OK;
+}
+
+void container_put_index_entry(uint8_t out[CONTAINER_INDEX_ENTRY_SIZE], const ContainerIndexEntry *entry) {
+    put_le64(out, entry->offset);
+    put_le64(out + 8, entry->raw_offset);
+    put_le32(out + 16, entry->raw_size);
+    put_le32(out + 20, entry->payload_size);
+}
+
+void container_get_index_entry(const uint8_t in[CONTAINER_INDEX_ENTRY_SIZE], ContainerIndexEntry *entry) {
+    entry->offset = get_le64(in);
+    entry->raw_offset = get_le64(in + 8);
+    entry->raw_size = get_le32(in + 16);
+    entry->payload_size = get_le32(in + 20);
+}
+
+void container_put_footer(uint8_t out[CONTAINER_FOOTER_SIZE], const ContainerFooter *footer) {
+    put_le64(out, footer->index_offset);
+    put_le64(out + 8, footer->raw_total);
+    put_le32(out + 16, footer->block_count);
+    memcpy(out + 20, CONTAINER_FOOTER_MAGIC, 4);
+}
+
+int container_get_footer(const uint8_t in[CONTAINER_FOOTER_SIZE], ContainerFooter *footer) {
+    if (memcmp(in + 20, CONTAINER_FOOTER_MAGIC, 4) != 0) return CONTAINER_ERR_FORMAT;
+    footer->index_offset = get_le64(in);
+    footer->raw_total = get_le64(in + 8);
+    footer->block_count = get_le32(in + 16);
+    return CONTAINER_OK;
+}
+
+// ----------------- Writer -----------------
+static int write_bytes(ContainerWriter *writer, const uint8_t *data, size_t size) {
+    if (size && fwrite(data, 1, size, writer->file) != size) return CONTAINER_ERR_IO;
+    writer->pos += size;
+    return CONTAINER_OK;
+}
+
+int container_writer_open(ContainerWriter *writer, FILE *file, uint32_t block_size) {
+    if (block_size == 0 || block_size > CONTAINER_MAX_BLOCK_SIZE) return CONTAINER_ERR_RANGE;
+
+    memset(writer, 0, sizeof(*writer));
+    writer->file = file;
+    writer->block_size = block_size;
+
+    uint8_t header[CONTAINER_FILE_HEADER_SIZE];
+    container_put_file_header(header, block_size);
+    return write_bytes(writer, header, sizeof(header));
+}
+
+int container_write_block(ContainerWriter *writer, uint8_t codec, const uint8_t *raw, uint32_t raw_size,
+                          const uint8_t *payload, uint32_t payload_size) {
+    if (codec == CONTAINER_CODEC_END || raw_size > writer->block_size) return CONTAINER_ERR_RANGE;
+
+    if (writer->block_count == writer->capacity) {
+        uint32_t capacity = writer->capacity ? writer->capacity * 2 : 64;
+        ContainerIndexEntry *index = realloc(writer->index, capacity * sizeof(ContainerIndexEntry));
+        if (!index) return CONTAINER_ERR_MEMORY;
+        writer->index = index;
+        writer->capacity = capacity;
+    }
+
+    ContainerIndexEntry *entry = &writer->index[writer->block_count++];
+    entry->offset = writer->pos;
+    entry->raw_offset = writer->raw_total;
+    entry->raw_size = raw_size;
+    entry->payload_size = payload_size;
+    writer->raw_total += raw_size;
+
+    ContainerBlockHeader header = {
+        .codec = codec,
+        .flags = 0,
+        .raw_size = raw_size,
+        .payload_size = payload_size,
+        .checksum = crc32_update(0, raw, raw_size)
+    };
+    uint8_t bytes[CONTAINER_BLOCK_HEADER_SIZE];
+    container_put_block_header(bytes, &header);
+
+    int err = write_bytes(writer, bytes, sizeof(bytes));
+    if (err) return err;
+    return write_bytes(writer, payload, payload_size);
+}
+
+int container_writer_close(ContainerWriter *writer) {
+    uint8_t bytes[CONTAINER_BLOCK_HEADER_SIZE];
+    ContainerBlockHeader end = { .codec = CONTAINER_CODEC_END };
+    container_put_block_header(bytes, &end);
+    int err = write_bytes(writer, bytes, sizeof(bytes));
+
+    ContainerFooter footer = {
+        .index_offset = writer->pos,
+        .raw_total = writer->raw_total,
+        .block_count = writer->block_count
+    };
+
+    for (uint32_t i = 0; i < writer->block_count && !err; i++) {
+        uint8_t entry[CONTAINER_INDEX_ENTRY_SIZE];
+        container_put_index_entry(entry, &writer->index[i]);
+        err = write_bytes(writer, entry, sizeof(entry));
+    }
+
+    if (!err) {
+        uint8_t tail[CONTAINER_FOOTER_SIZE];
+        container_put_footer(tail, &footer);
+        err = write_bytes(writer, tail, sizeof(tail));
+    }
+
+    free(writer->index);
+    writer->index = NULL;
+    return err;
+}
+
+// ----------------- Reader -----------------
+int container_reader_open(ContainerReader *reader, FILE *file) {
+    memset(reader, 0, sizeof(*reader));
+    reader->file = file;
+
+    uint8_t header[CONTAINER_FILE_HEADER_SIZE];
+    if (fseek(file, 0, SEEK_SET) != 0 || fread(header, 1, sizeof(header), file) != sizeof(header)) {
+        return CONTAINER_ERR_IO;
+    }
+    int err = container_get_file_header(header, &reader->block_size);
+    if (err) return err;
+
+    uint8_t tail[CONTAINER_FOOTER_SIZE];
+    ContainerFooter footer;
+    if (fseek(file, -(long)CONTAINER_FOOTER_SIZE, SEEK_END) != 0) return CONTAINER_ERR_FORMAT;
+    long file_size = ftell(file) + CONTAINER_FOOTER_SIZE;
+    if (fread(tail, 1, sizeof(tail), file) != sizeof(tail)) return CONTAINER_ERR_IO;
+    err = container_get_footer(tail, &footer);
+    if (err) return err;
+
+    // The index must exactly fill the space between the end marker and the footer
+    uint64_t index_bytes = (uint64_t)footer.block_count * CONTAINER_INDEX_ENTRY_SIZE;
+    if (footer.index_offset < CONTAINER_FILE_HEADER_SIZE + CONTAINER_BLOCK_HEADER_SIZE ||
+        footer.index_offset + index_bytes + CONTAINER_FOOTER_SIZE != (uint64_t)file_size) {
+        return CONTAINER_ERR_FORMAT;
+    }
+
+    reader->index = malloc((footer.block_count ? footer.block_count : 1) * sizeof(ContainerIndexEntry));
+    if (!reader->index) return CONTAINER_ERR_MEMORY;
+    if (fseek(file, (long)footer.index_offset, SEEK_SET) != 0) return CONTAINER_ERR_IO;
+
+    uint64_t raw_offset = 0;
+    for (uint32_t i = 0; i < footer.block_count; i++) {
+        uint8_t bytes[CONTAINER_INDEX_ENTRY_SIZE];
+        if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) return CONTAINER_ERR_IO;
+
+        ContainerIndexEntry *entry = &reader->index[i];
+        container_get_index_entry(bytes, entry);
+        if (entry->raw_offset != raw_offset || entry->raw_size > reader->block_size ||
+            entry->offset + CONTAINER_BLOCK_HEADER_SIZE + entry->payload_size > footer.index_offset) {
+            return CONTAINER_ERR_FORMAT;
+        }
+        raw_offset += entry->raw_size;
+    }
+    if (raw_offset != footer.raw_total) return CONTAINER_ERR_FORMAT;
+
+    reader->block_count = footer.block_count;
+    reader->raw_total = footer.raw_total;
+    return CONTAINER_OK;
+}
+
+int container_find_block(const ContainerReader *reader, uint64_t raw_offset) {
+    if (raw_offset >= reader->raw_total) return CONTAINER_ERR_RANGE;
+
+    // Binary search for the last block starting at or before raw_offset
+    uint32_t lo = 0, hi = reader->block_count;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (reader->index[mid].raw_offset <= raw_offset) lo = mid;
+        else hi = mid;
+    }
+    return (int)lo;
+}
+
+int container_read_block(ContainerReader *reader, uint32_t block, ContainerBlockHeader *header,
+                         uint8_t *payload, size_t capacity) {
+    if (block >= reader->block_count) return CONTAINER_ERR_RANGE;
+    const ContainerIndexEntry *entry = &reader->index[block];
+
+    uint8_t bytes[CONTAINER_BLOCK_HEADER_SIZE];
+    if (fseek(reader->file, (long)entry->offset, SEEK_SET) != 0 ||
+        fread(bytes, 1, sizeof(bytes), reader->file) != sizeof(bytes)) {
+        return CONTAINER_ERR_IO;
+    }
+    int err = container_get_block_header(bytes, header);
+    if (err) return err;
+    if (header->codec == CONTAINER_CODEC_END || header->raw_size != entry->raw_size ||
+        header->payload_size != entry->payload_size) {
+        return CONTAINER_ERR_FORMAT;
+    }
+    if (header->payload_size > capacity) return CONTAINER_ERR_RANGE;
+
+    if (fread(payload, 1, header->payload_size, reader->file) != header->payload_size) return CONTAINER_ERR_IO;
+    return CONTAINER_OK;
+}
+
+int container_verify_block(const ContainerBlockHeader *header, const uint8_t *raw) {
+    return crc32_update(0, raw, header->raw_size) == header->checksum ? CONTAINER_OK : CONTAINER_ERR_CHECKSUM;
+}
+
+void container_reader_close(ContainerReader *reader) {
+    free(reader->index);
+    reader->index = NULL;
+}
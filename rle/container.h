@@ -0,0 +1,160 @@
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+block-framed container shared by the rle/ codecs, all integers little-endian
+
+  file header   "HRLE", version, flags, reserved, nominal block size, reserved
+  blocks        block header (codec, flags, raw size, payload size, CRC-32 of
+                the raw bytes) followed by the codec payload
+  end marker    a block header with codec CONTAINER_CODEC_END
+  block index   one entry per block: file offset, raw offset, raw size, payload size
+  footer        index offset, total raw size, block count, "HRLX"
+
+the footer sits at a fixed distance from the end of the file, so a reader can
+load the index and jump straight to the block covering any raw offset
+*/
+
+#define CONTAINER_MAGIC "HRLE"
+#define CONTAINER_FOOTER_MAGIC "HRLX"
+#define CONTAINER_VERSION 1
+
+#define CONTAINER_FILE_HEADER_SIZE 16
+#define CONTAINER_BLOCK_HEADER_SIZE 16
+#define CONTAINER_INDEX_ENTRY_SIZE 24
+#define CONTAINER_FOOTER_SIZE 24
+
+#define CONTAINER_MAX_BLOCK_SIZE (64u << 20)  // readers reject anything larger
+
+// Codec ids stored in each block header
+enum {
+    CONTAINER_CODEC_RAW = 0,          // payload is the raw bytes
+    CONTAINER_CODEC_HUFFMAN = 1,      // canonical Huffman, chunked (huffman.c)
+    CONTAINER_CODEC_BLOCK_RLE = 2,    // 32-byte SIMD block RLE (rle.c)
+    CONTAINER_CODEC_BYTE_RLE = 3,     // (byte, run) pairs (rle.c)
+    CONTAINER_CODEC_MTF_HUFFMAN = 4,  // MTF then Huffman (codecs.c)
+    CONTAINER_CODEC_BWT = 5,          // BWT, MTF, Huffman (codecs.c)
+    CONTAINER_CODEC_HUFFMAN_X4 = 6,   // Huffman, 4 interleaved streams (huffman.c)
+    CONTAINER_CODEC_HUFFMAN_X16 = 7,  // Huffman, 16 streams for gather decoding (huffman.c)
+    CONTAINER_CODEC_ANS = 8,          // interleaved rANS (ans.c)
+    CONTAINER_CODEC_MTF_ANS = 9,      // MTF then rANS (codecs.c)
+    CONTAINER_CODEC_BWT_ANS = 10,     // BWT, MTF, rANS (codecs.c)
+    CONTAINER_CODEC_BWT_CM = 11,      // BWT, MTF, context-mixing arithmetic coder (codecs.c)
+    CONTAINER_CODEC_END = 0xFF        // end of blocks, index follows
+};
+
+// Error codes, all negative
+enum {
+    CONTAINER_OK = 0,
+    CONTAINER_ERR_IO = -1,
+    CONTAINER_ERR_FORMAT = -2,
+    CONTAINER_ERR_CHECKSUM = -3,
+    CONTAINER_ERR_MEMORY = -4,
+    CONTAINER_ERR_RANGE = -5
+};
+
+typedef struct {
+    uint8_t codec;
+    uint8_t flags;
+    uint32_t raw_size;
+    uint32_t payload_size;
+    uint32_t checksum;  // CRC-32 of the raw bytes
+} ContainerBlockHeader;
+
+typedef struct {
+    uint64_t offset;      // file offset of the block header
+    uint64_t raw_offset;  // offset of the block's first byte in the raw data
+    uint32_t raw_size;
+    uint32_t payload_size;
+} ContainerIndexEntry;
+
+typedef struct {
+    uint64_t index_offset;
+    uint64_t raw_total;
+    uint32_t block_count;
+} ContainerFooter;
+
+typedef struct {
+    FILE *file;
+    uint32_t block_size;
+    uint64_t pos;        // bytes written so far
+    uint64_t raw_total;
+    ContainerIndexEntry *index;
+    uint32_t block_count;
+    uint32_t capacity;
+} ContainerWriter;
+
+typedef struct {
+    FILE *file;
+    uint32_t block_size;
+    uint64_t raw_total;
+    ContainerIndexEntry *index;
+    uint32_t block_count;
+} ContainerReader;
+
+// ----------------- Little-Endian Helpers -----------------
+static inline void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static inline void put_le32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static inline void put_le64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = v >> (8 * i);
+}
+
+static inline uint16_t get_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static inline uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint64_t get_le64(const uint8_t *p) {
+    return (uint64_t)get_le32(p) | (uint64_t)get_le32(p + 4) << 32;
+}
+
+// ----------------- Bit Cost -----------------
+// log2(x) in 1/256 bits, x >= 1; the mantissa's log is a parabola through its ends, within 0.01 bits
+static inline uint32_t log2_fixed(uint32_t x) {
+    int e = 31 - __builtin_clz(x);
+    uint32_t f = (uint32_t)(((uint64_t)x << 8) >> e) - 256;
+    return (uint32_t)e * 256 + f + ((f * (256 - f) * 88) >> 16);
+}
+
+// ----------------- Checksum -----------------
+uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t size);
+
+// ----------------- Serialization -----------------
+void container_put_file_header(uint8_t out[CONTAINER_FILE_HEADER_SIZE], uint32_t block_size);
+int container_get_file_header(const uint8_t in[CONTAINER_FILE_HEADER_SIZE], uint32_t *block_size);
+void container_put_block_header(uint8_t out[CONTAINER_BLOCK_HEADER_SIZE], const ContainerBlockHeader *header);
+int container_get_block_header(const uint8_t in[CONTAINER_BLOCK_HEADER_SIZE], ContainerBlockHeader *header);
+void container_put_index_entry(uint8_t out[CONTAINER_INDEX_ENTRY_SIZE], const ContainerIndexEntry *entry);
+void container_get_index_entry(const uint8_t in[CONTAINER_INDEX_ENTRY_SIZE], ContainerIndexEntry *entry);
+void container_put_footer(uint8_t out[CONTAINER_FOOTER_SIZE], const ContainerFooter *footer);
+int container_get_footer(const uint8_t in[CONTAINER_FOOTER_SIZE], ContainerFooter *footer);
+
+// ----------------- Writer -----------------
+int container_writer_open(ContainerWriter *writer, FILE *file, uint32_t block_size);
+int container_write_block(ContainerWriter *writer, uint8_t codec, const uint8_t *raw, uint32_t raw_size,
+                          const uint8_t *payload, uint32_t payload_size);
+int container_writer_close(ContainerWriter *writer);  // writes end marker, index and footer
+
+// ----------------- Reader -----------------
+int container_reader_open(ContainerReader *reader, FILE *file);  // close the reader even if this fails
+int container_find_block(const ContainerReader *reader, uint64_t raw_offset);  // block number or CONTAINER_ERR_RANGE
+int container_read_block(ContainerReader *reader, uint32_t block, ContainerBlockHeader *header,
+                         uint8_t *payload, size_t capacity);
+int container_verify_block(const ContainerBlockHeader *header, const uint8_t *raw);
+void container_reader_close(ContainerReader *reader);
+
+#endif
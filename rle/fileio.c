@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "container.h"
+#include "fileio.h"
+
+// ----------------- File I/O -----------------
+uint8_t* read_file(const char *filename, size_t *size) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) return NULL;
+
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) length = ftell(file);
+    if (length < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    *size = length;
+    uint8_t *data = malloc(*size ? *size : 1);
+    if (data && fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    return data;
+}
+
+int write_file(const char *filename, const uint8_t *data, size_t size) {
+    FILE *file = fopen(filename, "wb");
+    if (!file) return CONTAINER_ERR_IO;
+
+    int err = fwrite(data, 1, size, file) == size ? CONTAINER_OK : CONTAINER_ERR_IO;
+    if (fclose(file) != 0) err = CONTAINER_ERR_IO;
+    return err;
+}
@@ -0,0 +1,11 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ----------------- File I/O -----------------
+uint8_t* read_file(const char *filename, size_t *size);  // NULL on failure, free() the result
+int write_file(const char *filename, const uint8_t *data, size_t size);  // CONTAINER_ERR_IO on failure
+
+#endif
@@ -0,0 +1,443 @@
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+#include "container.h"
+#include "filter.h"
+
+#define LZP_HASH_BITS 18
+#define LZP_MATCH 256                     // shortest match detection has LZP replace; the sort handles shorter ones well
+#define LZP_PROBE_BITS 16
+#define LZP_PROBE_SPAN 64                 // bytes per detection anchor
+#define TRANSPOSE_PROBE_SIZE (16u << 10)
+#define TRANSPOSE_MIN_PEAK 32             // in 1/256: a record width matches 1/8 more often than the widths beside it
+#define TRANSPOSE_FORCED_WIDTH 4          // forced transposition without a detected record: 32-bit fields
+#define SELECT_MARGIN 16                  // a trial must save 1/16 of the sample's cost to be used
+
+// The middle `limit` bytes of a block, or all of it
+static const uint8_t *middle(const uint8_t *input, size_t size, size_t limit, size_t *sample_size) {
+    *sample_size = size < limit ? size : limit;
+    return input + (size - *sample_size) / 2;
+}
+
+// ----------------- Delta -----------------
+// Each byte minus the one `stride` bytes before it: smooth samples become small differences
+static uint32_t delta_detect(const uint8_t *input, size_t size) {
+    // The stride whose differences pile up on the fewest values, by the sum of their squared counts
+    const uint8_t *sample = middle(input, size, FILTER_SAMPLE_SIZE, &size);
+    uint32_t best = 1;
+    uint64_t best_score = 0;
+    for (uint32_t stride = 1; stride <= FILTER_MAX_STRIDE && stride < size; stride++) {
+        uint32_t count[256] = { 0 };
+        for (size_t i = stride; i < size; i++) count[(uint8_t)(sample[i] - sample[i - stride])]++;
+        uint64_t score = 0;
+        for (int c = 0; c < 256; c++) score += (uint64_t)count[c] * count[c];
+        if (score > best_score) {
+            best_score = score;
+            best = stride;
+        }
+    }
+    return best;
+}
+
+static size_t same_bound(size_t size) {
+    return size;
+}
+
+static int delta_forward(const uint8_t *input, size_t size, uint32_t param, uint8_t *output, size_t *output_size) {
+    size_t stride = param < size ? param : size;
+    memcpy(output, input, stride);
+    for (size_t i = stride; i < size; i++) output[i] = input[i] - input[i - stride];
+    *output_size = size;
+    return CONTAINER_OK;
+}
+
+static int delta_inverse(const uint8_t *input, size_t input_size, uint32_t param, uint8_t *output, size_t size) {
+    if (param < 1 || param > FILTER_MAX_STRIDE || input_size != size) return CONTAINER_ERR_FORMAT;
+    size_t stride = param < size ? param : size;
+    memcpy(output, input, stride);
+    for (size_t i = stride; i < size; i++) output[i] = input[i] + output[i - stride];
+    return CONTAINER_OK;
+}
+
+// ----------------- Column Transposition -----------------
+/*
+fixed-width records stored column by column: every field's bytes end up
+side by side, so the sort sees long runs of similar values instead of
+records interleaving them; bytes past the last whole record stay at the end
+*/
+// Positions where a and b hold the same byte
+static size_t count_equal(const uint8_t *a, const uint8_t *b, size_t n) {
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    while (i + 32 <= n) {
+        // Each equal byte adds 1 to its lane; lanes are widened before 255 compares can wrap them
+        __m256i counts = _mm256_setzero_si256();
+        for (int k = 0; k < 255 && i + 32 <= n; k++, i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+            __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+            counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(x, y));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    size_t same = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; i++) same += a[i] == b[i];
+    return same;
+}
+
+static uint32_t transpose_detect(const uint8_t *input, size_t size) {
+    // Fraction of bytes equal to the one `width` before them, in 1/256, for every width
+    size_t n;
+    const uint8_t *sample = middle(input, size, TRANSPOSE_PROBE_SIZE, &n);
+    uint32_t rate[FILTER_MAX_WIDTH + 2] = { 0 };
+    for (size_t width = 1; width <= FILTER_MAX_WIDTH + 1 && width * 4 <= n; width++) {
+        rate[width] = count_equal(sample + width, sample, n - width) * 256 / (n - width);
+    }
+
+    /*
+    records show as a width matching far more often than its neighbours do,
+    which smooth data (matching at every small width) and text do not; the
+    record is the shortest such width, not a multiple of it
+    */
+    uint32_t peak[FILTER_MAX_WIDTH + 1] = { 0 }, top = 0;
+    for (uint32_t width = 2; width <= FILTER_MAX_WIDTH; width++) {
+        uint32_t around = rate[width - 1] > rate[width + 1] ? rate[width - 1] : rate[width + 1];
+        peak[width] = rate[width] > around ? rate[width] - around : 0;
+        if (peak[width] > top) top = peak[width];
+    }
+    if (top < TRANSPOSE_MIN_PEAK) return 0;
+    for (uint32_t width = 2; width <= FILTER_MAX_WIDTH; width++) {
+        if (peak[width] >= top - top / 8) return width;
+    }
+    return 0;
+}
+
+static int transpose_forward(const uint8_t *input, size_t size, uint32_t param, uint8_t *output, size_t *output_size) {
+    size_t width = param, rows = size / width;
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t j = 0; j < width; j++) output[j * rows + r] = input[r * width + j];
+    }
+    memcpy(output + rows * width, input + rows * width, size - rows * width);
+    *output_size = size;
+    return CONTAINER_OK;
+}
+
+static int transpose_inverse(const uint8_t *input, size_t input_size, uint32_t param, uint8_t *output, size_t size) {
+    if (param < 2 || param > FILTER_MAX_WIDTH || input_size != size) return CONTAINER_ERR_FORMAT;
+    size_t width = param, rows = size / width;
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t j = 0; j < width; j++) output[r * width + j] = input[j * rows + r];
+    }
+    memcpy(output + rows * width, input + rows * width, size - rows * width);
+    return CONTAINER_OK;
+}
+
+// ----------------- LZP -----------------
+/*
+the last position that followed the same 4 bytes of context predicts the
+next byte; where the prediction holds for at least `param` bytes, the
+match is replaced by an escape byte and its length, so long repeats cost
+the sort a few bytes instead of their full length
+
+output: the escape byte (the block's rarest), then the block with, at
+predicted positions only, a match as escape + LEB128 (length - param + 1)
+and a literal escape as escape + 0; the table is not updated inside matches
+*/
+static inline uint32_t lzp_hash(const uint8_t *p) {
+    uint32_t context;
+    memcpy(&context, p - 4, 4);
+    return (context * 2654435761u) >> (32 - LZP_HASH_BITS);
+}
+
+/*
+the repeats LZP is for lie farther apart than a sample spans, so detection
+probes the whole block at anchors, in every LZP_PROBE_SPAN bytes the
+position whose 4-byte context hashes lowest, so repeated content picks the
+same anchors wherever it sits; an anchor whose next 8 bytes were seen at an
+earlier one is extended into a match, and LZP pays when matches of
+LZP_MATCH bytes or more cover a third of the block
+*/
+static inline uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    return x ^ (x >> 16);
+}
+
+static uint32_t lzp_detect(const uint8_t *input, size_t size) {
+    if (size < 12) return 0;
+    uint32_t *table = calloc((size_t)1 << LZP_PROBE_BITS, sizeof(uint32_t));
+    if (!table) return 0;
+
+    size_t covered = 0;
+    for (size_t begin = 4; begin + 8 <= size;) {
+        size_t end = size - 8 - begin < LZP_PROBE_SPAN ? size - 7 : begin + LZP_PROBE_SPAN;
+        size_t anchor = begin;
+        uint32_t lowest = UINT32_MAX;
+        for (size_t i = begin; i < end; i++) {
+            uint32_t context;
+            memcpy(&context, input + i - 4, 4);
+            if (mix32(context) < lowest) {
+                lowest = mix32(context);
+                anchor = i;
+            }
+        }
+
+        uint64_t next;
+        memcpy(&next, input + anchor, 8);
+        uint32_t h = (uint32_t)((next * 0x9E3779B97F4A7C15ull) >> (64 - LZP_PROBE_BITS));
+        size_t earlier = table[h], length = 0;
+        table[h] = anchor;
+        if (earlier) {
+            while (anchor + length < size && input[earlier + length] == input[anchor + length]) length++;
+        }
+        if (length >= LZP_MATCH) {
+            covered += length;
+            begin = anchor + length;
+        } else {
+            begin = end;
+        }
+    }
+    free(table);
+    return covered * 3 >= size ? LZP_MATCH : 0;
+}
+
+static size_t lzp_bound(size_t size) {
+    // Only the rarest byte takes two bytes, and it occurs at most size / 256 times
+    return 1 + size + size / 256;
+}
+
+static int lzp_forward(const uint8_t *input, size_t size, uint32_t param, uint8_t *output, size_t *output_size) {
+    uint32_t *table = calloc((size_t)1 << LZP_HASH_BITS, sizeof(uint32_t));
+    if (!table) return CONTAINER_ERR_MEMORY;
+
+    size_t count[256] = { 0 };
+    for (size_t i = 0; i < size; i++) count[input[i]]++;
+    uint8_t escape = 0;
+    for (int c = 1; c < 256; c++) {
+        if (count[c] < count[escape]) escape = c;
+    }
+
+    size_t pos = 0;
+    output[pos++] = escape;
+    size_t i = size < 4 ? size : 4;
+    memcpy(output + pos, input, i);
+    pos += i;
+    while (i < size) {
+        uint32_t h = lzp_hash(input + i);
+        size_t predicted = table[h];
+        table[h] = i;
+        if (predicted) {
+            size_t length = 0;
+            while (i + length < size && input[predicted + length] == input[i + length]) length++;
+            if (length >= param) {
+                output[pos++] = escape;
+                for (size_t code = length - param + 1; ; code >>= 7) {
+                    output[pos++] = (uint8_t)(code & 0x7F) | (code >= 0x80 ? 0x80 : 0);
+                    if (code < 0x80) break;
+                }
+                i += length;
+                continue;
+            }
+            if (input[i] == escape) {
+                output[pos++] = escape;
+                output[pos++] = 0;
+                i++;
+                continue;
+            }
+        }
+        output[pos++] = input[i++];
+    }
+
+    free(table);
+    *output_size = pos;
+    return CONTAINER_OK;
+}
+
+static int lzp_inverse(const uint8_t *input, size_t input_size, uint32_t param, uint8_t *output, size_t size) {
+    if (param < FILTER_LZP_MIN_MATCH || input_size < 1) return CONTAINER_ERR_FORMAT;
+    uint32_t *table = calloc((size_t)1 << LZP_HASH_BITS, sizeof(uint32_t));
+    if (!table) return CONTAINER_ERR_MEMORY;
+
+    int err = CONTAINER_OK;
+    uint8_t escape = input[0];
+    size_t in = 1, i = 0;
+    while (i < size && i < 4 && in < input_size) output[i++] = input[in++];
+    while (i < size && !err) {
+        if (in >= input_size) {
+            err = CONTAINER_ERR_FORMAT;
+            break;
+        }
+        uint32_t h = lzp_hash(output + i);
+        size_t predicted = table[h];
+        table[h] = i;
+        uint8_t c = input[in++];
+        if (!predicted || c != escape) {
+            output[i++] = c;
+            continue;
+        }
+
+        uint64_t code = 0;
+        for (int shift = 0; ; shift += 7) {
+            if (in >= input_size || shift > 35) {
+                err = CONTAINER_ERR_FORMAT;
+                break;
+            }
+            uint8_t b = input[in++];
+            code |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+        }
+        if (err) break;
+        if (code == 0) {
+            output[i++] = escape;
+            continue;
+        }
+        uint64_t length = code - 1 + param;
+        if (length > size - i) {
+            err = CONTAINER_ERR_FORMAT;
+            break;
+        }
+        // Byte by byte: the match may overlap what it copies
+        for (size_t k = 0; k < length; k++) output[i + k] = output[predicted + k];
+        i += length;
+    }
+    if (!err && (i < size || in != input_size)) err = CONTAINER_ERR_FORMAT;
+
+    free(table);
+    return err;
+}
+
+// ----------------- Registry -----------------
+static const Filter delta_filter = {
+    .id = FILTER_DELTA,
+    .policy = FILTER_TRIAL,
+    .detect = delta_detect,
+    .forced_param = 1,
+    .bound = same_bound,
+    .forward = delta_forward,
+    .inverse = delta_inverse
+};
+
+static const Filter transpose_filter = {
+    .id = FILTER_TRANSPOSE,
+    .policy = FILTER_FALLBACK,
+    .detect = transpose_detect,
+    .forced_param = TRANSPOSE_FORCED_WIDTH,
+    .bound = same_bound,
+    .forward = transpose_forward,
+    .inverse = transpose_inverse
+};
+
+static const Filter lzp_filter = {
+    .id = FILTER_LZP,
+    .policy = FILTER_DECISIVE,
+    .detect = lzp_detect,
+    .forced_param = LZP_MATCH,
+    .bound = lzp_bound,
+    .forward = lzp_forward,
+    .inverse = lzp_inverse
+};
+
+const Filter *filter_get(int id) {
+    switch (id) {
+        case FILTER_DELTA: return &delta_filter;
+        case FILTER_TRANSPOSE: return &transpose_filter;
+        case FILTER_LZP: return &lzp_filter;
+        default: return NULL;
+    }
+}
+
+size_t filter_bound(size_t size) {
+    return lzp_bound(size);
+}
+
+// ----------------- Selection -----------------
+static int configured_mode = FILTER_AUTO;
+
+void filter_set_mode(int mode) {
+    if (mode < FILTER_AUTO || mode >= FILTER_COUNT) mode = FILTER_AUTO;
+    __atomic_store_n(&configured_mode, mode, __ATOMIC_RELAXED);
+}
+
+int filter_mode(void) {
+    return __atomic_load_n(&configured_mode, __ATOMIC_RELAXED);
+}
+
+/*
+bits an order-1 model would spend on data, in 1/256 bits: the stand-in for
+what the BWT pipeline makes of it, cheap enough to run on every candidate;
+count holds 256 * 256 entries
+*/
+static uint64_t order1_cost(const uint8_t *data, size_t size, uint32_t *count) {
+    memset(count, 0, 256 * 256 * sizeof(uint32_t));
+    for (size_t i = 1; i < size; i++) count[data[i - 1] << 8 | data[i]]++;
+
+    uint64_t cost = 0;
+    for (int context = 0; context < 256; context++) {
+        const uint32_t *row = count + (context << 8);
+        uint64_t total = 0, sum = 0;
+        for (int c = 0; c < 256; c++) {
+            if (!row[c]) continue;
+            total += row[c];
+            sum += (uint64_t)row[c] * log2_fixed(row[c]);
+        }
+        if (total) cost += total * log2_fixed((uint32_t)total) - sum;
+    }
+    return cost;
+}
+
+static const Filter *const candidates[] = { &lzp_filter, &transpose_filter, &delta_filter };
+#define CANDIDATE_COUNT (int)(sizeof(candidates) / sizeof(candidates[0]))
+
+const Filter *filter_select(const uint8_t *input, size_t size, uint32_t *param) {
+    int mode = filter_mode();
+    if (mode == FILTER_NONE || size < FILTER_MIN_SIZE) return NULL;
+    if (mode != FILTER_AUTO) {
+        const Filter *filter = filter_get(mode);
+        *param = filter->detect(input, size);
+        if (!*param) *param = filter->forced_param;
+        return filter;
+    }
+
+    uint32_t proposed[CANDIDATE_COUNT];
+    for (int i = 0; i < CANDIDATE_COUNT; i++) {
+        proposed[i] = candidates[i]->detect(input, size);
+        if (proposed[i] && candidates[i]->policy == FILTER_DECISIVE) {
+            *param = proposed[i];
+            return candidates[i];
+        }
+    }
+
+    // Filtering only ever helps the ratio, so without memory for the trial the block goes unfiltered
+    size_t sample_size;
+    const uint8_t *sample = middle(input, size, FILTER_SAMPLE_SIZE, &sample_size);
+    uint32_t *count = malloc(256 * 256 * sizeof(uint32_t));
+    uint8_t *trial = malloc(filter_bound(sample_size));
+    const Filter *best = NULL;
+    if (count && trial) {
+        uint64_t best_cost = order1_cost(sample, sample_size, count);
+        best_cost -= best_cost / SELECT_MARGIN;
+        for (int i = 0; i < CANDIDATE_COUNT; i++) {
+            size_t trial_size;
+            if (!proposed[i] || candidates[i]->forward(sample, sample_size, proposed[i], trial, &trial_size)) continue;
+            uint64_t cost = order1_cost(trial, trial_size, count);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best = candidates[i];
+                *param = proposed[i];
+            }
+        }
+    }
+    for (int i = 0; i < CANDIDATE_COUNT && !best; i++) {
+        if (proposed[i] && candidates[i]->policy == FILTER_FALLBACK) {
+            best = candidates[i];
+            *param = proposed[i];
+        }
+    }
+
+    free(trial);
+    free(count);
+    return best;
+}
@@ -0,0 +1,63 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ----------------- Pre-BWT Filters -----------------
+/*
+reversible transforms run on a block before the BWT pipeline sorts it:
+byte delta for images, column transposition for fixed-width records, LZP
+to cut long repeats out before sorting; one filter per block at most
+
+detection looks at a sample of the block, or probes all of it where a
+sample would not show what the filter is for (LZP's repeats lie farther
+apart than a sample spans); what auto mode does with a detection is the
+filter's policy
+*/
+enum {
+    FILTER_AUTO = -1,     // mode only: choose per block
+    FILTER_NONE = 0,
+    FILTER_DELTA = 1,     // param: stride in bytes, 1..FILTER_MAX_STRIDE
+    FILTER_TRANSPOSE = 2, // param: record width in bytes, 2..FILTER_MAX_WIDTH
+    FILTER_LZP = 3        // param: shortest match replaced, FILTER_LZP_MIN_MATCH or more
+};
+#define FILTER_COUNT 4
+
+#define FILTER_MAX_STRIDE 4
+#define FILTER_MAX_WIDTH 1024
+#define FILTER_LZP_MIN_MATCH 8
+#define FILTER_SAMPLE_SIZE (64u << 10)  // bytes from the middle of a block trials run on
+#define FILTER_MIN_SIZE 4096            // smaller blocks are never filtered
+
+// Auto mode policies
+enum {
+    FILTER_TRIAL,     // run on a sample from the middle of the block; of those whose order-1 cost there
+                      // undercuts the unfiltered sample's by a margin, the cheapest is used
+    FILTER_FALLBACK,  // tried likewise, and used on detection alone when no trial pays
+    FILTER_DECISIVE   // used as soon as it is detected, ahead of any trial
+};
+
+// A filter plugged into the BWT pipelines
+typedef struct {
+    uint8_t id;                                              // FILTER_*
+    int policy;                                              // FILTER_TRIAL, FILTER_FALLBACK or FILTER_DECISIVE
+    uint32_t (*detect)(const uint8_t *input, size_t size);   // parameter worth using on this block, 0 if none
+    uint32_t forced_param;                                   // what a forced mode runs with where detect finds none
+    size_t (*bound)(size_t size);                            // worst-case forward output
+    int (*forward)(const uint8_t *input, size_t size, uint32_t param, uint8_t *output, size_t *output_size);
+    int (*inverse)(const uint8_t *input, size_t input_size, uint32_t param, uint8_t *output, size_t size);
+} Filter;
+
+const Filter *filter_get(int id);   // NULL for FILTER_NONE and unknown ids
+size_t filter_bound(size_t size);   // worst-case forward output of any filter
+
+// Process-wide mode, like the thread count: FILTER_AUTO (the default), FILTER_NONE or a filter to force
+// on every block of FILTER_MIN_SIZE or more
+void filter_set_mode(int mode);
+int filter_mode(void);
+
+// Filter for a block under the current mode, NULL to leave it as is; *param receives its parameter
+const Filter *filter_select(const uint8_t *input, size_t size, uint32_t *param);
+
+#endif
@@ -0,0 +1,896 @@
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+#include "container.h"
+#include "huffman.h"
+#include "parallel.h"
+
+#define MAX_TREE_NODES 511
+
+typedef struct HuffmanNode {
+    uint8_t symbol;
+    uint32_t freq;
+    struct HuffmanNode *left, *right;
+} HuffmanNode;
+
+typedef struct {
+    HuffmanNode *nodes[MAX_TREE_NODES];
+    int size;
+} PriorityQueue;
+
+// ----------------- Priority Queue -----------------
+static void pq_push(PriorityQueue *pq, HuffmanNode *node) {
+    int i = pq->size++;
+    while (i > 0 && node->freq < pq->nodes[(i - 1) / 2]->freq) {
+        pq->nodes[i] = pq->nodes[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    pq->nodes[i] = node;
+}
+
+static HuffmanNode* pq_pop(PriorityQueue *pq) {
+    HuffmanNode *top = pq->nodes[0];
+    HuffmanNode *last = pq->nodes[--pq->size];
+    int i = 0;
+    while (2 * i + 1 < pq->size) {
+        int j = 2 * i + 1;
+        if (j + 1 < pq->size && pq->nodes[j + 1]->freq < pq->nodes[j]->freq) j++;
+        if (last->freq <= pq->nodes[j]->freq) break;
+        pq->nodes[i] = pq->nodes[j];
+        i = j;
+    }
+    pq->nodes[i] = last;
+    return top;
+}
+
+// ----------------- Huffman Tree -----------------
+// Builds the tree out of `pool` (MAX_TREE_NODES nodes), NULL if every frequency is zero
+static HuffmanNode* build_huffman_tree(const uint32_t freq[256], HuffmanNode *pool) {
+    PriorityQueue pq = { .size = 0 };
+    int used = 0;
+
+    for (int i = 0; i < 256; i++) {
+        if (freq[i] > 0) {
+            HuffmanNode *node = &pool[used++];
+            node->symbol = i;
+            node->freq = freq[i];
+            node->left = node->right = NULL;
+            pq_push(&pq, node);
+        }
+    }
+
+    while (pq.size > 1) {
+        HuffmanNode *left = pq_pop(&pq);
+        HuffmanNode *right = pq_pop(&pq);
+        HuffmanNode *parent = &pool[used++];
+        parent->symbol = 0;
+        parent->freq = left->freq + right->freq;
+        parent->left = left;
+        parent->right = right;
+        pq_push(&pq, parent);
+    }
+
+    return pq.size > 0 ? pq_pop(&pq) : NULL;
+}
+
+// ----------------- Canonical Code Lengths -----------------
+/*
+one table serializes on its counters: a run of equal bytes makes every
+increment wait for the previous store to the same slot. four tables, one per
+byte lane of a 32-bit word, keep four independent chains in flight and the
+next word is loaded while the current one is counted; the tables are summed
+at the end
+*/
+#define HIST_TABLES 4
+
+static inline void count_word(uint32_t tables[HIST_TABLES][256], uint32_t word) {
+    tables[0][(uint8_t)word]++;
+    tables[1][(uint8_t)(word >> 8)]++;
+    tables[2][(uint8_t)(word >> 16)]++;
+    tables[3][word >> 24]++;
+}
+
+void count_frequencies(const uint8_t *data, size_t size, uint32_t freq[256]) {
+    uint32_t tables[HIST_TABLES][256];
+    memset(tables, 0, sizeof(tables));
+
+    size_t i = 0;
+    if (size >= 20) {
+        uint32_t word = get_le32(data), next;
+        for (; i + 20 <= size; i += 16) {
+            next = get_le32(data + i + 4);
+            count_word(tables, word);
+            word = get_le32(data + i + 8);
+            count_word(tables, next);
+            next = get_le32(data + i + 12);
+            count_word(tables, word);
+            word = get_le32(data + i + 16);
+            count_word(tables, next);
+        }
+    }
+    for (; i < size; i++) tables[0][data[i]]++;
+
+    for (int c = 0; c < 256; c++) freq[c] = tables[0][c] + tables[1][c] + tables[2][c] + tables[3][c];
+}
+
+static void collect_depths(HuffmanNode *node, int depth, int depths[256]) {
+    if (!node) return;
+    if (!node->left && !node->right) {
+        depths[node->symbol] = depth ? depth : 1;  // a lone symbol still needs one bit
+        return;
+    }
+    collect_depths(node->left, depth + 1, depths);
+    collect_depths(node->right, depth + 1, depths);
+}
+
+/*
+optimal Huffman lengths from the tree, then codes deeper than max_len are
+clamped and the Kraft sum is repaired by pushing shorter codes down a level;
+the most frequent symbols get the shortest lengths
+*/
+void compute_code_lengths(const uint32_t freq[256], uint8_t lengths[256], int max_len) {
+    int depths[256] = {0};
+    HuffmanNode pool[MAX_TREE_NODES];
+    collect_depths(build_huffman_tree(freq, pool), 0, depths);
+
+    int bl_count[HUFF_MAX_CODE_LEN_LIMIT + 1] = {0};
+    for (int i = 0; i < 256; i++) {
+        if (depths[i]) bl_count[depths[i] < max_len ? depths[i] : max_len]++;
+    }
+
+    uint32_t total = 0;
+    for (int len = 1; len <= max_len; len++) {
+        total += (uint32_t)bl_count[len] << (max_len - len);
+    }
+    while (total > (1u << max_len)) {
+        bl_count[max_len]--;
+        for (int len = max_len - 1; len > 0; len--) {
+            if (bl_count[len]) {
+                bl_count[len]--;
+                bl_count[len + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // Order symbols by descending frequency (insertion sort, ties by symbol)
+    int order[256], n = 0;
+    for (int i = 0; i < 256; i++) {
+        if (!freq[i]) continue;
+        int j = n++;
+        while (j > 0 && freq[order[j - 1]] < freq[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    memset(lengths, 0, 256);
+    int k = 0;
+    for (int len = 1; len <= max_len; len++) {
+        for (int c = 0; c < bl_count[len]; c++) lengths[order[k++]] = len;
+    }
+}
+
+// Assigns canonical codes: shorter codes first, ties in symbol order
+void build_canonical_codes(const uint8_t lengths[256], HuffmanCode codes[256]) {
+    int bl_count[HUFF_MAX_CODE_LEN_LIMIT + 1] = {0};
+    for (int i = 0; i < 256; i++) bl_count[lengths[i]]++;
+    bl_count[0] = 0;
+
+    uint32_t next_code[HUFF_MAX_CODE_LEN_LIMIT + 1];
+    uint32_t code = 0;
+    for (int len = 1; len <= HUFF_MAX_CODE_LEN_LIMIT; len++) {
+        code = (code + bl_count[len - 1]) << 1;
+        next_code[len] = code;
+    }
+
+    for (int i = 0; i < 256; i++) {
+        codes[i].length = lengths[i];
+        codes[i].code = lengths[i] ? next_code[lengths[i]]++ : 0;
+    }
+}
+
+// ----------------- Code Length Header -----------------
+// 256 code lengths, two per byte (high nibble first)
+void store_code_lengths(const uint8_t lengths[256], uint8_t output[HUFF_HEADER_SIZE]) {
+    for (int i = 0; i < HUFF_HEADER_SIZE; i++) {
+        output[i] = (lengths[2 * i] << 4) | lengths[2 * i + 1];
+    }
+}
+
+int load_code_lengths(const uint8_t input[HUFF_HEADER_SIZE], uint8_t lengths[256]) {
+    uint32_t kraft = 0;
+    for (int i = 0; i < HUFF_HEADER_SIZE; i++) {
+        lengths[2 * i] = input[i] >> 4;
+        lengths[2 * i + 1] = input[i] & 0x0F;
+    }
+    for (int i = 0; i < 256; i++) {
+        if (lengths[i]) kraft += 1u << (HUFF_MAX_CODE_LEN_LIMIT - lengths[i]);
+    }
+    return kraft > (1u << HUFF_MAX_CODE_LEN_LIMIT) ? CONTAINER_ERR_FORMAT : CONTAINER_OK;
+}
+
+// ----------------- Bit Writer -----------------
+typedef struct {
+    uint8_t *data;
+    size_t pos;     // whole bytes written so far
+    uint64_t bits;  // MSB-aligned accumulator
+    int count;      // pending bits in the accumulator
+} BitWriter;
+
+// Stores all 8 accumulator bytes and advances past the complete ones; needs 8 bytes of slack
+static inline void bitwriter_flush(BitWriter *bw) {
+    uint64_t word = __builtin_bswap64(bw->bits);
+    memcpy(bw->data + bw->pos, &word, 8);
+    bw->pos += bw->count >> 3;
+    bw->bits <<= bw->count & ~7;
+    bw->count &= 7;
+}
+
+static inline void bitwriter_put(BitWriter *bw, uint32_t code, int length) {
+    bw->bits |= (uint64_t)code << (64 - bw->count - length);
+    bw->count += length;
+    // Keep room for one more code of up to HUFF_MAX_CODE_LEN_LIMIT bits
+    if (bw->count >= 64 - HUFF_MAX_CODE_LEN_LIMIT) bitwriter_flush(bw);
+}
+
+// Writes out the last partial byte (zero padded), returns the total bytes written
+static inline size_t bitwriter_finish(BitWriter *bw) {
+    bitwriter_flush(bw);
+    if (bw->count) {
+        bw->data[bw->pos++] = bw->bits >> 56;
+        bw->bits = 0;
+        bw->count = 0;
+    }
+    return bw->pos;
+}
+
+size_t huffman_encode_bound(size_t size) {
+    return size * HUFF_MAX_CODE_LEN / 8 + 16;
+}
+
+// Codes the symbols after `skip_bits` zero bits, so the output can be OR-ed into a stream at any bit offset
+static size_t encode_symbols(const uint8_t *input, size_t size, const HuffmanCode codes[256], uint8_t *output,
+                             int skip_bits) {
+    BitWriter bw = { .data = output, .pos = 0, .bits = 0, .count = skip_bits };
+    for (size_t i = 0; i < size; i++) {
+        HuffmanCode code = codes[input[i]];
+        bitwriter_put(&bw, code.code, code.length);
+    }
+    return bitwriter_finish(&bw);
+}
+
+size_t huffman_encode_buffer(const uint8_t *input, size_t size, const HuffmanCode codes[256], uint8_t *output) {
+    return encode_symbols(input, size, codes, output, 0);
+}
+
+// ----------------- Table-Driven Decoding -----------------
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;     // next byte to load into the reservoir
+    uint64_t bits;  // MSB-aligned bit reservoir
+    int count;      // valid bits in the reservoir
+    int invalid;    // set once a code that is not in the table was seen
+} BitReader;
+
+void build_decode_table(const uint8_t lengths[256], HuffmanTable *table) {
+    HuffmanCode codes[256];
+    build_canonical_codes(lengths, codes);
+
+    memset(table->entries, 0, sizeof(table->entries));
+    memcpy(table->lengths, lengths, ALPHABET_SIZE);
+
+    int max_len = 0;
+    for (int i = 0; i < 256; i++) {
+        if (lengths[i] > max_len) max_len = lengths[i];
+    }
+    table->sub_bits = max_len > HUFF_TABLE_BITS ? max_len - HUFF_TABLE_BITS : 0;
+
+    int next_subtable = 0;
+    for (int i = 0; i < 256; i++) {
+        int len = lengths[i];
+        if (!len) continue;
+
+        if (len <= HUFF_TABLE_BITS) {
+            int shift = HUFF_TABLE_BITS - len;
+            for (uint32_t j = codes[i].code << shift; j < (codes[i].code + 1u) << shift; j++) {
+                table->entries[j].symbols[0] = i;
+                table->entries[j].count = 1;
+                table->entries[j].bits = len;
+            }
+            continue;
+        }
+
+        // Long code: the prefix selects a secondary table, the rest of the code indexes it
+        int extra = len - HUFF_TABLE_BITS;
+        uint32_t prefix = codes[i].code >> extra;
+        if (!table->entries[prefix].bits) {
+            table->entries[prefix].bits = HUFF_TABLE_BITS;
+            table->subtables[prefix] = next_subtable;
+            memset(&table->secondary[next_subtable], 0, sizeof(HuffmanTableEntry) << table->sub_bits);
+            next_subtable += 1 << table->sub_bits;
+        }
+
+        HuffmanTableEntry *sub = &table->secondary[table->subtables[prefix]];
+        uint32_t rest = codes[i].code & ((1u << extra) - 1);
+        int shift = table->sub_bits - extra;
+        for (uint32_t j = rest << shift; j < (rest + 1) << shift; j++) {
+            sub[j].symbols[0] = i;
+            sub[j].count = 1;
+            sub[j].bits = extra;
+        }
+    }
+
+    // Pair up symbols whose codes both fit in one lookup
+    HuffmanTableEntry single[HUFF_TABLE_SIZE];
+    memcpy(single, table->entries, sizeof(single));
+
+    for (int i = 0; i < HUFF_TABLE_SIZE; i++) {
+        HuffmanTableEntry first = single[i];
+        if (first.count != 1) continue;
+
+        HuffmanTableEntry second = single[(i << first.bits) & HUFF_TABLE_MASK];
+        if (second.count == 1 && first.bits + second.bits <= HUFF_TABLE_BITS) {
+            table->entries[i].symbols[1] = second.symbols[0];
+            table->entries[i].count = 2;
+            table->entries[i].bits = first.bits + second.bits;
+        }
+    }
+}
+
+static inline void bitreader_refill(BitReader *br) {
+    if (br->pos + 8 <= br->size) {
+        // Load 8 bytes at once and keep only the whole bytes that fit
+        uint64_t word;
+        memcpy(&word, br->data + br->pos, 8);
+        br->bits |= __builtin_bswap64(word) >> br->count;
+        br->pos += (63 - br->count) >> 3;
+        br->count |= 56;
+    } else {
+        // Near the end pad with zero bytes; overruns are caught after decoding
+        while (br->count <= 56) {
+            uint64_t byte = br->pos < br->size ? br->data[br->pos] : 0;
+            br->bits |= byte << (56 - br->count);
+            br->pos++;
+            br->count += 8;
+        }
+    }
+}
+
+static inline void bitreader_consume(BitReader *br, int bits) {
+    br->bits <<= bits;
+    br->count -= bits;
+}
+
+// Decodes one table lookup (one or two symbols); needs HUFF_TABLE_BITS bits in the reservoir
+static inline int decode_step(const HuffmanTable *table, BitReader *br, uint8_t *out) {
+    uint32_t index = br->bits >> (64 - HUFF_TABLE_BITS);
+    HuffmanTableEntry entry = table->entries[index];
+
+    if (entry.count) {
+        out[0] = entry.symbols[0];
+        out[1] = entry.symbols[1];
+        bitreader_consume(br, entry.bits);
+        return entry.count;
+    }
+
+    // Long code: finish it in the secondary table
+    if (entry.bits) {
+        bitreader_consume(br, HUFF_TABLE_BITS);
+        bitreader_refill(br);
+        const HuffmanTableEntry *sub = &table->secondary[table->subtables[index]];
+        entry = sub[br->bits >> (64 - table->sub_bits)];
+    }
+    if (!entry.count) {
+        // Not a code: emit a placeholder so the loops still terminate, the caller reports it
+        br->invalid = 1;
+        out[0] = 0;
+        bitreader_consume(br, 1);
+        return 1;
+    }
+    out[0] = entry.symbols[0];
+    bitreader_consume(br, entry.bits);
+    return 1;
+}
+
+// Finishes a stream one lookup at a time and checks it stayed inside its input
+static int decode_tail(const HuffmanTable *table, BitReader *br, uint8_t *output, size_t output_pos, size_t size) {
+    // A paired lookup may run past the last symbol, don't count those bits
+    size_t overshoot = 0;
+    while (output_pos < size) {
+        uint8_t symbols[2];
+        bitreader_refill(br);
+        int n = decode_step(table, br, symbols);
+        output[output_pos++] = symbols[0];
+        if (n == 2) {
+            if (output_pos < size) output[output_pos++] = symbols[1];
+            else overshoot = table->lengths[symbols[1]];
+        }
+    }
+
+    size_t consumed_bits = br->pos * 8 - br->count - overshoot;
+    if (br->invalid || consumed_bits > br->size * 8) return CONTAINER_ERR_FORMAT;
+    return CONTAINER_OK;
+}
+
+// Decodes exactly `size` symbols from an in-memory bitstream
+int huffman_decode_buffer(const HuffmanTable *table, const uint8_t *input, size_t input_size,
+                          uint8_t *output, size_t size) {
+    BitReader br = { .data = input, .size = input_size, .pos = 0, .bits = 0, .count = 0, .invalid = 0 };
+    size_t output_pos = 0;
+
+    // Fast path: a refill holds at least 56 bits, enough for four lookups
+    while (output_pos + 8 <= size) {
+        bitreader_refill(&br);
+        output_pos += decode_step(table, &br, &output[output_pos]);
+        output_pos += decode_step(table, &br, &output[output_pos]);
+        output_pos += decode_step(table, &br, &output[output_pos]);
+        output_pos += decode_step(table, &br, &output[output_pos]);
+    }
+
+    return decode_tail(table, &br, output, output_pos, size);
+}
+
+// ----------------- Chunk Threads -----------------
+typedef struct {
+    const uint8_t *input;
+    size_t size;
+    uint32_t freq[256];
+    const HuffmanCode *codes;
+    uint8_t *output;
+    size_t output_size;
+    uint8_t *stream;      // contiguous mode: the shared bitstream
+    uint64_t bit_offset;  // contiguous mode: first bit of this chunk in it
+} CompressTask;
+
+typedef struct {
+    const HuffmanTable *table;
+    const uint8_t *input;    // this chunk's compressed bytes
+    size_t input_size;
+    uint8_t *output;         // this chunk's region of the output buffer
+    size_t symbols;          // uncompressed symbol count of the chunk
+    int result;
+} DecompressTask;
+
+static void* count_chunk_thread(void *arg) {
+    CompressTask *task = arg;
+    count_frequencies(task->input, task->size, task->freq);
+    return NULL;
+}
+
+static void* compress_chunk_thread(void *arg) {
+    CompressTask *task = arg;
+    task->output_size = huffman_encode_buffer(task->input, task->size, task->codes, task->output);
+    return NULL;
+}
+
+// Bytes strictly inside the chunk are its own; the first and last may be shared and are merged afterwards
+static void* compress_contiguous_thread(void *arg) {
+    CompressTask *task = arg;
+    task->output_size = encode_symbols(task->input, task->size, task->codes, task->output, task->bit_offset & 7);
+    if (task->output_size > 2) {
+        memcpy(task->stream + (task->bit_offset >> 3) + 1, task->output + 1, task->output_size - 2);
+    }
+    return NULL;
+}
+
+static void* decompress_chunk_thread(void *arg) {
+    DecompressTask *task = arg;
+    task->result = huffman_decode_buffer(task->table, task->input, task->input_size, task->output, task->symbols);
+    return NULL;
+}
+
+// ----------------- Compression -----------------
+size_t huffman_compress_bound(size_t size) {
+    return HUFF_HEADER_SIZE + 4 + 8 * HUFF_THREADS + size * HUFF_MAX_CODE_LEN / 8 + HUFF_THREADS;
+}
+
+// Splits the input into chunks with their own encode buffers and builds the codes from all of them
+static int prepare_chunks(const uint8_t *input, size_t size, CompressTask tasks[HUFF_THREADS],
+                          uint8_t lengths[256], HuffmanCode codes[256]) {
+    size_t chunk_size = size / HUFF_THREADS;
+
+    for (int t = 0; t < HUFF_THREADS; t++) {
+        tasks[t].input = input + t * chunk_size;
+        tasks[t].size = t == HUFF_THREADS - 1 ? size - t * chunk_size : chunk_size;
+        tasks[t].output = malloc(huffman_encode_bound(tasks[t].size));
+        tasks[t].codes = codes;
+        if (!tasks[t].output) {
+            while (t-- > 0) free(tasks[t].output);
+            return CONTAINER_ERR_MEMORY;
+        }
+    }
+
+    // Per-chunk histograms, merged into one set of length-limited canonical codes
+    parallel_run(count_chunk_thread, tasks, sizeof(CompressTask), HUFF_THREADS);
+    uint32_t freq[256] = {0};
+    for (int t = 0; t < HUFF_THREADS; t++) {
+        for (int i = 0; i < 256; i++) freq[i] += tasks[t].freq[i];
+    }
+
+    compute_code_lengths(freq, lengths, HUFF_MAX_CODE_LEN);
+    build_canonical_codes(lengths, codes);
+    return CONTAINER_OK;
+}
+
+int huffman_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    CompressTask tasks[HUFF_THREADS];
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    int err = prepare_chunks(input, size, tasks, lengths, codes);
+    if (err) return err;
+
+    parallel_run(compress_chunk_thread, tasks, sizeof(CompressTask), HUFF_THREADS);
+
+    // Chunk index up front so the decompressor can locate every chunk and decode them all in parallel
+    store_code_lengths(lengths, output);
+    size_t output_pos = HUFF_HEADER_SIZE;
+    put_le32(&output[output_pos], HUFF_THREADS);
+    output_pos += 4;
+    for (int t = 0; t < HUFF_THREADS; t++) {
+        put_le32(&output[output_pos], tasks[t].size);
+        put_le32(&output[output_pos + 4], tasks[t].output_size);
+        output_pos += 8;
+    }
+
+    for (int t = 0; t < HUFF_THREADS; t++) {
+        memcpy(&output[output_pos], tasks[t].output, tasks[t].output_size);
+        output_pos += tasks[t].output_size;
+        free(tasks[t].output);
+    }
+
+    *output_size = output_pos;
+    return CONTAINER_OK;
+}
+
+// ----------------- Contiguous Compression -----------------
+int huffman_compress_contiguous(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    CompressTask tasks[HUFF_THREADS];
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    int err = prepare_chunks(input, size, tasks, lengths, codes);
+    if (err) return err;
+
+    // Exact bit length of every chunk from its histogram, prefix-summed into start offsets
+    uint8_t *stream = output + HUFF_HEADER_SIZE + 4 + 8;
+    uint64_t total_bits = 0;
+    for (int t = 0; t < HUFF_THREADS; t++) {
+        tasks[t].stream = stream;
+        tasks[t].bit_offset = total_bits;
+        for (int i = 0; i < 256; i++) total_bits += (uint64_t)tasks[t].freq[i] * lengths[i];
+    }
+    size_t stream_size = (total_bits + 7) / 8;
+
+    parallel_run(compress_contiguous_thread, tasks, sizeof(CompressTask), HUFF_THREADS);
+
+    // Boundary bytes: every chunk holds zeros outside its own bits, so OR-ing them together merges neighbours
+    for (int t = 0; t < HUFF_THREADS; t++) {
+        size_t first = tasks[t].bit_offset >> 3;
+        if (tasks[t].output_size) stream[first] = stream[first + tasks[t].output_size - 1] = 0;
+    }
+    for (int t = 0; t < HUFF_THREADS; t++) {
+        size_t first = tasks[t].bit_offset >> 3;
+        if (tasks[t].output_size) {
+            stream[first] |= tasks[t].output[0];
+            stream[first + tasks[t].output_size - 1] |= tasks[t].output[tasks[t].output_size - 1];
+        }
+        free(tasks[t].output);
+    }
+
+    store_code_lengths(lengths, output);
+    put_le32(&output[HUFF_HEADER_SIZE], 1);
+    put_le32(&output[HUFF_HEADER_SIZE + 4], size);
+    put_le32(&output[HUFF_HEADER_SIZE + 8], stream_size);
+    *output_size = HUFF_HEADER_SIZE + 4 + 8 + stream_size;
+    return CONTAINER_OK;
+}
+
+// ----------------- Decompression -----------------
+int huffman_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    if (input_size < HUFF_HEADER_SIZE + 4) return CONTAINER_ERR_FORMAT;
+
+    uint8_t lengths[256];
+    if (load_code_lengths(input, lengths) != CONTAINER_OK) return CONTAINER_ERR_FORMAT;
+
+    size_t input_pos = HUFF_HEADER_SIZE;
+    uint32_t num_chunks = get_le32(&input[input_pos]);
+    input_pos += 4;
+    if (num_chunks == 0 || num_chunks > (input_size - input_pos) / 8) return CONTAINER_ERR_FORMAT;
+
+    HuffmanTable *table = malloc(sizeof(HuffmanTable));
+    DecompressTask *tasks = malloc(num_chunks * sizeof(DecompressTask));
+    if (!table || !tasks) {
+        free(table);
+        free(tasks);
+        return CONTAINER_ERR_MEMORY;
+    }
+    build_decode_table(lengths, table);
+
+    int err = CONTAINER_OK;
+    size_t output_pos = 0;
+    size_t data_pos = input_pos + 8 * (size_t)num_chunks;
+    for (uint32_t chunk = 0; chunk < num_chunks && !err; chunk++) {
+        size_t chunk_symbols = get_le32(&input[input_pos]);
+        size_t chunk_size = get_le32(&input[input_pos + 4]);
+        input_pos += 8;
+
+        if (chunk_symbols > size - output_pos || chunk_size > input_size - data_pos) {
+            err = CONTAINER_ERR_FORMAT;
+            break;
+        }
+
+        tasks[chunk].table = table;
+        tasks[chunk].input = &input[data_pos];
+        tasks[chunk].input_size = chunk_size;
+        tasks[chunk].output = &output[output_pos];
+        tasks[chunk].symbols = chunk_symbols;
+        output_pos += chunk_symbols;
+        data_pos += chunk_size;
+    }
+    if (!err && output_pos != size) err = CONTAINER_ERR_FORMAT;
+
+    // Decode the chunks concurrently
+    if (!err) {
+        parallel_run(decompress_chunk_thread, tasks, sizeof(DecompressTask), num_chunks);
+        for (uint32_t chunk = 0; chunk < num_chunks && !err; chunk++) err = tasks[chunk].result;
+    }
+
+    free(tasks);
+    free(table);
+    return err;
+}
+
+// ----------------- 4-Stream Interleaved Huffman -----------------
+// Symbols of segment k, the k-th quarter of the block (the last one may be shorter)
+static size_t x4_segment_size(size_t size, int k) {
+    size_t segment = (size + HUFF_X4_STREAMS - 1) / HUFF_X4_STREAMS;
+    size_t start = (size_t)k * segment < size ? (size_t)k * segment : size;
+    return size - start < segment ? size - start : segment;
+}
+
+size_t huffman_x4_bound(size_t size) {
+    return HUFF_HEADER_SIZE + 4 * (HUFF_X4_STREAMS - 1) + huffman_encode_bound(size) + HUFF_X4_STREAMS;
+}
+
+int huffman_x4_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    uint32_t freq[256];
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    count_frequencies(input, size, freq);
+    compute_code_lengths(freq, lengths, HUFF_MAX_CODE_LEN);
+    build_canonical_codes(lengths, codes);
+    store_code_lengths(lengths, output);
+
+    // Each stream's bit writer slack lands where the next stream starts, which overwrites it
+    size_t output_pos = HUFF_HEADER_SIZE + 4 * (HUFF_X4_STREAMS - 1);
+    size_t input_pos = 0;
+    for (int k = 0; k < HUFF_X4_STREAMS; k++) {
+        size_t segment = x4_segment_size(size, k);
+        size_t stream_size = huffman_encode_buffer(input + input_pos, segment, codes, output + output_pos);
+        if (k < HUFF_X4_STREAMS - 1) put_le32(&output[HUFF_HEADER_SIZE + 4 * k], stream_size);
+        input_pos += segment;
+        output_pos += stream_size;
+    }
+
+    *output_size = output_pos;
+    return CONTAINER_OK;
+}
+
+int huffman_x4_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    size_t input_pos = HUFF_HEADER_SIZE + 4 * (HUFF_X4_STREAMS - 1);
+    if (input_size < input_pos) return CONTAINER_ERR_FORMAT;
+
+    uint8_t lengths[256];
+    if (load_code_lengths(input, lengths) != CONTAINER_OK) return CONTAINER_ERR_FORMAT;
+
+    // Stream bounds from the jump table, the last stream takes the rest of the payload
+    BitReader br[HUFF_X4_STREAMS];
+    uint8_t *out[HUFF_X4_STREAMS];
+    size_t done[HUFF_X4_STREAMS], count[HUFF_X4_STREAMS];
+    size_t output_pos = 0;
+    for (int k = 0; k < HUFF_X4_STREAMS; k++) {
+        size_t stream_size = k < HUFF_X4_STREAMS - 1 ? get_le32(&input[HUFF_HEADER_SIZE + 4 * k])
+                                                      : input_size - input_pos;
+        if (stream_size > input_size - input_pos) return CONTAINER_ERR_FORMAT;
+        br[k] = (BitReader){ .data = input + input_pos, .size = stream_size, .pos = 0, .bits = 0, .count = 0, .invalid = 0 };
+        input_pos += stream_size;
+
+        out[k] = output + output_pos;
+        done[k] = 0;
+        count[k] = x4_segment_size(size, k);
+        output_pos += count[k];
+    }
+
+    HuffmanTable *table = malloc(sizeof(HuffmanTable));
+    if (!table) return CONTAINER_ERR_MEMORY;
+    build_decode_table(lengths, table);
+
+    // The four readers are independent, so their lookups overlap instead of waiting on each other
+    for (;;) {
+        int k = 0;
+        while (k < HUFF_X4_STREAMS && done[k] + 8 <= count[k]) k++;
+        if (k < HUFF_X4_STREAMS) break;
+
+        for (k = 0; k < HUFF_X4_STREAMS; k++) bitreader_refill(&br[k]);
+        for (int step = 0; step < 4; step++) {
+            for (k = 0; k < HUFF_X4_STREAMS; k++) done[k] += decode_step(table, &br[k], out[k] + done[k]);
+        }
+    }
+
+    int err = CONTAINER_OK;
+    for (int k = 0; k < HUFF_X4_STREAMS && !err; k++) err = decode_tail(table, &br[k], out[k], done[k], count[k]);
+    free(table);
+    return err;
+}
+
+// ----------------- Gather-Decoded Interleaved Huffman -----------------
+/*
+symbol i goes to stream i % streams and codes are at most HUFF_TABLE_BITS
+long, so one table lookup always resolves exactly one symbol: the AVX2
+decoder keeps a bit position per stream in a vector lane, fetches every
+lane's next 32 bits with one gather and its table entry with another, and
+stores `streams` consecutive output bytes per round
+*/
+typedef struct {
+    uint32_t entries[HUFF_TABLE_SIZE];  // bits << 8 | symbol, 0 = not a code
+} GatherTable;
+
+static void build_gather_table(const uint8_t lengths[256], GatherTable *table) {
+    HuffmanCode codes[256];
+    build_canonical_codes(lengths, codes);
+    memset(table->entries, 0, sizeof(table->entries));
+    for (int i = 0; i < 256; i++) {
+        int len = lengths[i];
+        if (!len) continue;
+        int shift = HUFF_TABLE_BITS - len;
+        for (uint32_t j = codes[i].code << shift; j < (codes[i].code + 1u) << shift; j++) {
+            table->entries[j] = (uint32_t)len << 8 | i;
+        }
+    }
+}
+
+size_t huffman_gather_bound(size_t size) {
+    return HUFF_HEADER_SIZE + 1 + 4 * (HUFF_GATHER_MAX_STREAMS - 1) + size * HUFF_TABLE_BITS / 8 +
+           HUFF_GATHER_MAX_STREAMS + 16;
+}
+
+int huffman_gather_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size, int streams) {
+    if (streams != 8 && streams != HUFF_GATHER_MAX_STREAMS) return CONTAINER_ERR_RANGE;
+
+    uint32_t freq[256];
+    uint8_t lengths[256];
+    HuffmanCode codes[256];
+    count_frequencies(input, size, freq);
+    compute_code_lengths(freq, lengths, HUFF_TABLE_BITS);
+    build_canonical_codes(lengths, codes);
+    store_code_lengths(lengths, output);
+    output[HUFF_HEADER_SIZE] = streams;
+
+    size_t output_pos = HUFF_HEADER_SIZE + 1 + 4 * (size_t)(streams - 1);
+    for (int k = 0; k < streams; k++) {
+        BitWriter bw = { .data = output + output_pos, .pos = 0, .bits = 0, .count = 0 };
+        for (size_t i = k; i < size; i += streams) bitwriter_put(&bw, codes[input[i]].code, codes[input[i]].length);
+        size_t stream_size = bitwriter_finish(&bw);
+        if (k < streams - 1) put_le32(&output[HUFF_HEADER_SIZE + 1 + 4 * k], stream_size);
+        output_pos += stream_size;
+    }
+
+    *output_size = output_pos;
+    return CONTAINER_OK;
+}
+
+// Next HUFF_TABLE_BITS bits of a stream at `bit`, zero past its end
+static inline uint32_t gather_peek(const uint8_t *data, size_t end, uint64_t bit) {
+    uint32_t window = 0;
+    for (int b = 0; b < 3; b++) {
+        size_t pos = (bit >> 3) + b;
+        window = window << 8 | (pos < end ? data[pos] : 0);
+    }
+    return (window << (8 + (bit & 7))) >> (32 - HUFF_TABLE_BITS);
+}
+
+// One round over 8 streams: every lane reads its next 32 bits at its own bit position
+static inline __m256i gather_round(const uint8_t *data, const GatherTable *table, __m256i pos, uint8_t *out,
+                                   __m256i *invalid) {
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i low_bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                               0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i word = _mm256_i32gather_epi32((const int *)data, _mm256_srli_epi32(pos, 3), 1);
+    word = _mm256_sllv_epi32(_mm256_shuffle_epi8(word, bswap), _mm256_and_si256(pos, _mm256_set1_epi32(7)));
+    __m256i entry = _mm256_i32gather_epi32((const int *)table->entries, _mm256_srli_epi32(word, 32 - HUFF_TABLE_BITS), 4);
+
+    __m256i bits = _mm256_srli_epi32(entry, 8);
+    *invalid = _mm256_or_si256(*invalid, _mm256_cmpeq_epi32(bits, _mm256_setzero_si256()));
+    __m256i symbols = _mm256_shuffle_epi8(entry, low_bytes);
+    uint32_t lo = _mm256_cvtsi256_si32(symbols), hi = _mm256_extract_epi32(symbols, 4);
+    memcpy(out, &lo, 4);
+    memcpy(out + 4, &hi, 4);
+    return _mm256_add_epi32(pos, bits);
+}
+
+int huffman_gather_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    if (input_size < HUFF_HEADER_SIZE + 1) return CONTAINER_ERR_FORMAT;
+    int streams = input[HUFF_HEADER_SIZE];
+    size_t input_pos = HUFF_HEADER_SIZE + 1 + 4 * (size_t)(streams - 1);
+    if ((streams != 8 && streams != HUFF_GATHER_MAX_STREAMS) || input_size < input_pos) return CONTAINER_ERR_FORMAT;
+    // Lane bit positions are 32-bit
+    if (input_size - input_pos >= (1u << 28)) return CONTAINER_ERR_FORMAT;
+
+    uint8_t lengths[256];
+    if (load_code_lengths(input, lengths) != CONTAINER_OK) return CONTAINER_ERR_FORMAT;
+    for (int i = 0; i < 256; i++) {
+        if (lengths[i] > HUFF_TABLE_BITS) return CONTAINER_ERR_FORMAT;
+    }
+
+    // Positions are bits from the start of the stream data; a lane's stream ends at end[k] bytes
+    const uint8_t *data = input + input_pos;
+    size_t data_size = input_size - input_pos;
+    uint32_t pos[HUFF_GATHER_MAX_STREAMS], end[HUFF_GATHER_MAX_STREAMS];
+    size_t offset = 0;
+    for (int k = 0; k < streams; k++) {
+        size_t stream_size = k < streams - 1 ? get_le32(&input[HUFF_HEADER_SIZE + 1 + 4 * k]) : data_size - offset;
+        if (stream_size > data_size - offset) return CONTAINER_ERR_FORMAT;
+        pos[k] = offset * 8;
+        offset += stream_size;
+        end[k] = offset;
+    }
+
+    GatherTable *table = malloc(sizeof(GatherTable));
+    if (!table) return CONTAINER_ERR_MEMORY;
+    build_gather_table(lengths, table);
+
+    /*
+    a round moves a lane at most HUFF_TABLE_BITS bits and its gather reads 4
+    bytes, so the number of rounds that stay inside every stream is known
+    up front and the inner loop needs no bounds checks
+    */
+    size_t rounds = size / streams, round = 0;
+    __m256i invalid = _mm256_setzero_si256();
+    while (round < rounds) {
+        size_t safe = rounds - round;
+        for (int k = 0; k < streams; k++) {
+            uint64_t room = (uint64_t)end[k] * 8;
+            room = room >= (uint64_t)pos[k] + 32 ? (room - pos[k] - 32) / HUFF_TABLE_BITS : 0;
+            if (room < safe) safe = room;
+        }
+        if (!safe) break;
+
+        __m256i lanes0 = _mm256_loadu_si256((const __m256i *)pos);
+        if (streams == 8) {
+            for (size_t r = 0; r < safe; r++) {
+                lanes0 = gather_round(data, table, lanes0, output + (round + r) * 8, &invalid);
+            }
+        } else {
+            // Two independent halves per round keep both gathers in flight
+            __m256i lanes1 = _mm256_loadu_si256((const __m256i *)(pos + 8));
+            for (size_t r = 0; r < safe; r++) {
+                uint8_t *out = output + (round + r) * HUFF_GATHER_MAX_STREAMS;
+                lanes0 = gather_round(data, table, lanes0, out, &invalid);
+                lanes1 = gather_round(data, table, lanes1, out + 8, &invalid);
+            }
+            _mm256_storeu_si256((__m256i *)(pos + 8), lanes1);
+        }
+        _mm256_storeu_si256((__m256i *)pos, lanes0);
+        round += safe;
+    }
+
+    // Rounds too close to a stream end, and the last partial round, one symbol at a time
+    int err = _mm256_testz_si256(invalid, invalid) ? CONTAINER_OK : CONTAINER_ERR_FORMAT;
+    for (size_t i = round * streams; i < size && !err; i++) {
+        int k = i % streams;
+        uint32_t entry = table->entries[gather_peek(data, end[k], pos[k])];
+        if (!entry) err = CONTAINER_ERR_FORMAT;
+        output[i] = entry;
+        pos[k] += entry >> 8;
+    }
+    for (int k = 0; k < streams && !err; k++) {
+        if (pos[k] > end[k] * 8) err = CONTAINER_ERR_FORMAT;
+    }
+
+    free(table);
+    return err;
+}
@@ -0,0 +1,93 @@
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ALPHABET_SIZE 256
+#define HUFF_MAX_CODE_LEN 12        // code length limit used by the compressor (11..15)
+#define HUFF_MAX_CODE_LEN_LIMIT 15  // largest length a nibble in the header can hold
+#define HUFF_HEADER_SIZE (ALPHABET_SIZE / 2)
+#define HUFF_THREADS 6              // chunks per block, coded in parallel (parallel.h)
+#define HUFF_X4_STREAMS 4
+#define HUFF_GATHER_MAX_STREAMS 16
+
+#define HUFF_TABLE_BITS 11
+#define HUFF_TABLE_SIZE (1 << HUFF_TABLE_BITS)
+#define HUFF_TABLE_MASK (HUFF_TABLE_SIZE - 1)
+#define HUFF_SECONDARY_SIZE (ALPHABET_SIZE << (HUFF_MAX_CODE_LEN_LIMIT - HUFF_TABLE_BITS))
+
+typedef struct {
+    uint16_t code;   // canonical code, right-aligned
+    uint8_t length;  // 0 = symbol unused
+} HuffmanCode;
+
+/*
+one lookup on the next HUFF_TABLE_BITS bits resolves up to two symbols;
+longer codes index a small secondary table with their remaining bits
+*/
+typedef struct {
+    uint8_t symbols[2];
+    uint8_t count;  // symbols resolved by this entry, 0 = long code (or invalid if bits == 0)
+    uint8_t bits;   // bits consumed by this entry
+} HuffmanTableEntry;
+
+typedef struct HuffmanTable {
+    HuffmanTableEntry entries[HUFF_TABLE_SIZE];
+    uint16_t subtables[HUFF_TABLE_SIZE];            // secondary offset, only used when count == 0
+    HuffmanTableEntry secondary[HUFF_SECONDARY_SIZE];
+    int sub_bits;                                   // index bits of every secondary table
+    uint8_t lengths[ALPHABET_SIZE];
+} HuffmanTable;
+
+// ----------------- Code Construction -----------------
+void count_frequencies(const uint8_t *data, size_t size, uint32_t freq[256]);
+void compute_code_lengths(const uint32_t freq[256], uint8_t lengths[256], int max_len);
+void build_canonical_codes(const uint8_t lengths[256], HuffmanCode codes[256]);
+void store_code_lengths(const uint8_t lengths[256], uint8_t output[HUFF_HEADER_SIZE]);
+int load_code_lengths(const uint8_t input[HUFF_HEADER_SIZE], uint8_t lengths[256]);  // CONTAINER_ERR_FORMAT on bad Kraft sum
+
+// ----------------- Raw Bitstreams -----------------
+size_t huffman_encode_bound(size_t size);  // includes the 8 bytes of slack the bit writer needs
+size_t huffman_encode_buffer(const uint8_t *input, size_t size, const HuffmanCode codes[256], uint8_t *output);
+void build_decode_table(const uint8_t lengths[256], HuffmanTable *table);
+int huffman_decode_buffer(const HuffmanTable *table, const uint8_t *input, size_t input_size,
+                          uint8_t *output, size_t size);
+
+// ----------------- Block Payload -----------------
+/*
+code lengths, number of chunks, then the uncompressed symbol count and
+compressed size of each chunk (u32 little-endian), then the chunk data back
+to back; chunks are encoded and decoded concurrently
+*/
+size_t huffman_compress_bound(size_t size);
+int huffman_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size);
+
+/*
+one chunk holding exactly the huffman_encode_buffer bitstream of the whole
+block, still encoded in parallel: per-chunk bit lengths from the histograms
+give each thread its starting bit; decoding it is single-threaded
+*/
+int huffman_compress_contiguous(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size);
+int huffman_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+// ----------------- Interleaved Streams -----------------
+/*
+4 streams, Huff0 style: code lengths, the byte sizes of streams 0..2
+(u32 little-endian, stream 3 is the rest), then the streams; stream k holds
+the k-th quarter of the block and one loop decodes all four
+*/
+size_t huffman_x4_bound(size_t size);
+int huffman_x4_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size);
+int huffman_x4_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+/*
+8 or 16 streams for AVX2 gather decoding: code lengths (at most
+HUFF_TABLE_BITS), the stream count (u8), the byte sizes of all streams but
+the last, then the streams; symbol i is in stream i % streams
+*/
+size_t huffman_gather_bound(size_t size);
+int huffman_gather_compress(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size, int streams);
+int huffman_gather_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+#endif
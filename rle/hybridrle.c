@@ -0,0 +1,373 @@
+#include <stdlib.h>
+#include <string.h>
+#include "hybridrle.h"
+#include "stream.h"
+#include "parallel.h"
+#include "bwt.h"
+#include "filter.h"
+
+// The public ids and codes are the container's own, so nothing needs translating
+_Static_assert((int)HRLE_CODEC_BWT_CM == (int)CONTAINER_CODEC_BWT_CM, "codec ids must match the container");
+_Static_assert((int)HRLE_FILTER_LZP == (int)FILTER_LZP && (int)HRLE_FILTER_AUTO == (int)FILTER_AUTO,
+               "filter ids must match filter.h");
+_Static_assert((int)HRLE_ENTROPY_AUTO == (int)STREAM_ENTROPY_AUTO && (int)HRLE_ENTROPY_FIXED == (int)STREAM_ENTROPY_FIXED,
+               "entropy modes must match stream.h");
+_Static_assert((int)HRLE_ERR_RANGE == (int)CONTAINER_ERR_RANGE, "error codes must match the container");
+_Static_assert(HRLE_MAX_BLOCK_SIZE == CONTAINER_MAX_BLOCK_SIZE, "block size limit must match the container");
+
+struct HrleCStream {
+    CompressStream stream;
+};
+
+struct HrleDStream {
+    DecompressStream stream;
+};
+
+static const char *codec_names[] = { "raw", "huffman", "block-rle", "byte-rle", "mtf-huffman", "bwt",
+                                      "huffman-x4", "huffman-x16", "ans", "mtf-ans", "bwt-ans", "bwt-cm" };
+#define CODEC_COUNT (int)(sizeof(codec_names) / sizeof(codec_names[0]))
+
+const char *hrle_codec_name(int codec) {
+    return codec >= 0 && codec < CODEC_COUNT ? codec_names[codec] : "unknown";
+}
+
+int hrle_codec_from_name(const char *name) {
+    for (int i = 0; i < CODEC_COUNT; i++) {
+        if (strcmp(name, codec_names[i]) == 0) return i;
+    }
+    return HRLE_ERR_RANGE;
+}
+
+const char *hrle_error_string(int err) {
+    switch (err) {
+        case HRLE_OK: return "success";
+        case HRLE_ERR_IO: return "I/O error";
+        case HRLE_ERR_FORMAT: return "invalid or corrupt data";
+        case HRLE_ERR_CHECKSUM: return "checksum mismatch";
+        case HRLE_ERR_MEMORY: return "out of memory";
+        case HRLE_ERR_RANGE: return "argument out of range";
+        default: return "unknown error";
+    }
+}
+
+void hrle_set_threads(int threads) {
+    parallel_set_threads(threads);
+}
+
+int hrle_threads(void) {
+    return parallel_threads();
+}
+
+void hrle_set_bwt_window(uint32_t window) {
+    bwt_set_window(window);
+}
+
+uint32_t hrle_bwt_window(void) {
+    return bwt_window();
+}
+
+void hrle_set_bwt_filter(int filter) {
+    filter_set_mode(filter);
+}
+
+int hrle_bwt_filter(void) {
+    return filter_mode();
+}
+
+void hrle_set_entropy(int mode) {
+    stream_set_entropy(mode);
+}
+
+int hrle_entropy(void) {
+    return stream_entropy();
+}
+
+// Indexed by filter id + 1, "auto" first
+static const char *filter_names[] = { "auto", "none", "delta", "transpose", "lzp" };
+_Static_assert(sizeof(filter_names) / sizeof(filter_names[0]) == FILTER_COUNT + 1, "one name per filter");
+
+const char *hrle_filter_name(int filter) {
+    return filter >= FILTER_AUTO && filter < FILTER_COUNT ? filter_names[filter + 1] : "unknown";
+}
+
+int hrle_filter_from_name(const char *name) {
+    for (int i = FILTER_AUTO; i < FILTER_COUNT; i++) {
+        if (strcmp(name, filter_names[i + 1]) == 0) return i;
+    }
+    return HRLE_ERR_RANGE;
+}
+
+// Codec for a public id; RAW maps to NULL, which the stream stores verbatim
+static int lookup_codec(int codec, const StreamCodec **out) {
+    if (codec == HRLE_CODEC_RAW) {
+        *out = NULL;
+        return HRLE_OK;
+    }
+    *out = codec > 0 && codec < CODEC_COUNT ? stream_codec(codec) : NULL;
+    return *out ? HRLE_OK : HRLE_ERR_RANGE;
+}
+
+// ----------------- Buffer API -----------------
+size_t hrle_compress_bound(int codec, size_t size, uint32_t block_size) {
+    const StreamCodec *sc;
+    if (lookup_codec(codec, &sc) != HRLE_OK) return 0;
+    if (block_size == 0) block_size = HRLE_DEFAULT_BLOCK_SIZE;
+
+    size_t full = size / block_size, rest = size % block_size;
+    size_t blocks = full + (rest != 0);
+
+    // A block never grows past its raw size (it falls back to RAW), so only the headers add up
+    return CONTAINER_FILE_HEADER_SIZE + blocks * (CONTAINER_BLOCK_HEADER_SIZE + CONTAINER_INDEX_ENTRY_SIZE) +
+           size + CONTAINER_BLOCK_HEADER_SIZE + CONTAINER_FOOTER_SIZE;
+}
+
+int hrle_compress(int codec, uint32_t block_size, const uint8_t *src, size_t src_size,
+                  uint8_t *dst, size_t dst_capacity, size_t *dst_size) {
+    const StreamCodec *sc;
+    int err = lookup_codec(codec, &sc);
+    if (err) return err;
+    if (block_size == 0) block_size = HRLE_DEFAULT_BLOCK_SIZE;
+
+    CompressStream stream;
+    err = cstream_init(&stream, sc, block_size, 0);
+
+    size_t used = 0;
+    *dst_size = 0;
+    while (!err) {
+        size_t consumed = 0, produced = 0;
+        err = cstream_feed(&stream, src + used, src_size - used, &consumed);
+        used += consumed;
+        if (!err && used == src_size && !stream.finishing) err = cstream_finish(&stream);
+        if (!err) err = cstream_drain(&stream, dst + *dst_size, dst_capacity - *dst_size, &produced);
+        *dst_size += produced;
+
+        if (err || consumed || produced) continue;
+        // Nothing moved: either everything is out, or dst is full
+        if (!cstream_done(&stream)) err = HRLE_ERR_RANGE;
+        break;
+    }
+
+    cstream_free(&stream);
+    return err;
+}
+
+int hrle_decompressed_size(const uint8_t *src, size_t src_size, uint64_t *size) {
+    uint32_t block_size;
+    ContainerFooter footer;
+    if (src_size < CONTAINER_FILE_HEADER_SIZE + CONTAINER_BLOCK_HEADER_SIZE + CONTAINER_FOOTER_SIZE ||
+        container_get_file_header(src, &block_size) != CONTAINER_OK ||
+        container_get_footer(src + src_size - CONTAINER_FOOTER_SIZE, &footer) != CONTAINER_OK) {
+        return HRLE_ERR_FORMAT;
+    }
+    *size = footer.raw_total;
+    return HRLE_OK;
+}
+
+int hrle_decompress(const uint8_t *src, size_t src_size, uint8_t *dst, size_t dst_capacity, size_t *dst_size) {
+    DecompressStream stream;
+    int err = dstream_init(&stream, 0);
+
+    size_t used = 0;
+    *dst_size = 0;
+    while (!err) {
+        size_t consumed = 0, produced = 0;
+        err = dstream_feed(&stream, src + used, src_size - used, &consumed);
+        used += consumed;
+        if (!err) err = dstream_drain(&stream, dst + *dst_size, dst_capacity - *dst_size, &produced);
+        *dst_size += produced;
+
+        if (err || consumed || produced) continue;
+        if (dstream_pending(&stream)) err = HRLE_ERR_RANGE;  // dst is full
+        else err = dstream_finish(&stream);
+        break;
+    }
+
+    dstream_free(&stream);
+    return err;
+}
+
+// ----------------- Stream API -----------------
+HrleCStream *hrle_cstream_create(int codec, uint32_t block_size) {
+    const StreamCodec *sc;
+    if (lookup_codec(codec, &sc) != HRLE_OK) return NULL;
+    if (block_size == 0) block_size = HRLE_DEFAULT_BLOCK_SIZE;
+
+    HrleCStream *stream = malloc(sizeof(HrleCStream));
+    if (!stream) return NULL;
+    if (cstream_init(&stream->stream, sc, block_size, 0) != CONTAINER_OK) {
+        hrle_cstream_free(stream);
+        return NULL;
+    }
+    return stream;
+}
+
+int hrle_cstream_feed(HrleCStream *stream, const uint8_t *input, size_t size, size_t *consumed) {
+    return cstream_feed(&stream->stream, input, size, consumed);
+}
+
+int hrle_cstream_drain(HrleCStream *stream, uint8_t *output, size_t capacity, size_t *produced) {
+    return cstream_drain(&stream->stream, output, capacity, produced);
+}
+
+int hrle_cstream_finish(HrleCStream *stream) {
+    return cstream_finish(&stream->stream);
+}
+
+void hrle_cstream_free(HrleCStream *stream) {
+    if (!stream) return;
+    cstream_free(&stream->stream);
+    free(stream);
+}
+
+HrleDStream *hrle_dstream_create(void) {
+    HrleDStream *stream = malloc(sizeof(HrleDStream));
+    if (stream) dstream_init(&stream->stream, 0);
+    return stream;
+}
+
+int hrle_dstream_feed(HrleDStream *stream, const uint8_t *input, size_t size, size_t *consumed) {
+    return dstream_feed(&stream->stream, input, size, consumed);
+}
+
+int hrle_dstream_drain(HrleDStream *stream, uint8_t *output, size_t capacity, size_t *produced) {
+    return dstream_drain(&stream->stream, output, capacity, produced);
+}
+
+int hrle_dstream_finish(HrleDStream *stream) {
+    return dstream_finish(&stream->stream);
+}
+
+void hrle_dstream_free(HrleDStream *stream) {
+    if (!stream) return;
+    dstream_free(&stream->stream);
+    free(stream);
+}
+
+// ----------------- File API -----------------
+#define IO_BUFFER_SIZE (64 * 1024)
+
+int hrle_compress_file(int codec, uint32_t block_size, FILE *in, FILE *out, uint64_t *written) {
+    HrleCStream *stream = hrle_cstream_create(codec, block_size);
+    uint8_t *inbuf = malloc(IO_BUFFER_SIZE);
+    uint8_t *outbuf = malloc(IO_BUFFER_SIZE);
+    int err = stream && inbuf && outbuf ? HRLE_OK : HRLE_ERR_MEMORY;
+    if (!stream && inbuf && outbuf) err = HRLE_ERR_RANGE;
+
+    uint64_t total = 0;
+    int finished = 0;
+    while (!err && !finished) {
+        size_t got = fread(inbuf, 1, IO_BUFFER_SIZE, in);
+        if (got == 0) {
+            if (ferror(in)) {
+                err = HRLE_ERR_IO;
+                break;
+            }
+            hrle_cstream_finish(stream);
+            finished = 1;
+        }
+
+        // Alternate feeding and draining until this buffer is consumed (and, at the end, until nothing is left)
+        size_t used = 0;
+        while (!err) {
+            size_t consumed = 0, produced = 0;
+            err = hrle_cstream_feed(stream, inbuf + used, got - used, &consumed);
+            if (!err) err = hrle_cstream_drain(stream, outbuf, IO_BUFFER_SIZE, &produced);
+            if (!err && fwrite(outbuf, 1, produced, out) != produced) err = HRLE_ERR_IO;
+            used += consumed;
+            total += produced;
+            if (used == got && produced < IO_BUFFER_SIZE) break;
+        }
+    }
+
+    if (written) *written = total;
+    free(outbuf);
+    free(inbuf);
+    hrle_cstream_free(stream);
+    return err;
+}
+
+int hrle_decompress_file(FILE *in, FILE *out, uint64_t *written) {
+    HrleDStream *stream = hrle_dstream_create();
+    uint8_t *inbuf = malloc(IO_BUFFER_SIZE);
+    uint8_t *outbuf = malloc(IO_BUFFER_SIZE);
+    int err = stream && inbuf && outbuf ? HRLE_OK : HRLE_ERR_MEMORY;
+
+    uint64_t total = 0;
+    size_t got;
+    while (!err && (got = fread(inbuf, 1, IO_BUFFER_SIZE, in)) > 0) {
+        size_t used = 0;
+        while (!err) {
+            size_t consumed = 0, produced = 0;
+            err = hrle_dstream_feed(stream, inbuf + used, got - used, &consumed);
+            if (!err) err = hrle_dstream_drain(stream, outbuf, IO_BUFFER_SIZE, &produced);
+            if (!err && fwrite(outbuf, 1, produced, out) != produced) err = HRLE_ERR_IO;
+            used += consumed;
+            total += produced;
+            if (used == got && produced == 0) break;
+        }
+    }
+    if (!err) err = ferror(in) ? HRLE_ERR_IO : hrle_dstream_finish(stream);
+
+    if (written) *written = total;
+    free(outbuf);
+    free(inbuf);
+    hrle_dstream_free(stream);
+    return err;
+}
+
+// Decodes block `block` of an open container into raw, which must hold the block size
+static int read_block(ContainerReader *reader, uint32_t block, uint8_t **payload, size_t *capacity, uint8_t *raw) {
+    const ContainerIndexEntry *entry = &reader->index[block];
+    if (entry->payload_size > *capacity) {
+        uint8_t *grown = realloc(*payload, entry->payload_size);
+        if (!grown) return HRLE_ERR_MEMORY;
+        *payload = grown;
+        *capacity = entry->payload_size;
+    }
+
+    ContainerBlockHeader header;
+    int err = container_read_block(reader, block, &header, *payload, *capacity);
+    if (err) return err;
+
+    const StreamCodec *codec = stream_codec(header.codec);
+    if (header.codec == CONTAINER_CODEC_RAW) {
+        if (header.payload_size != header.raw_size) return HRLE_ERR_FORMAT;
+        memcpy(raw, *payload, header.raw_size);
+    } else if (!codec || header.payload_size > codec->bound(header.raw_size)) {
+        return HRLE_ERR_FORMAT;
+    } else {
+        err = codec->decompress(*payload, header.payload_size, raw, header.raw_size);
+        if (err) return err;
+    }
+    return container_verify_block(&header, raw);
+}
+
+int hrle_decompress_range(FILE *file, uint64_t offset, size_t length, uint8_t *output) {
+    ContainerReader reader;
+    int err = container_reader_open(&reader, file);
+    if (!err && offset + length > reader.raw_total) err = HRLE_ERR_RANGE;
+
+    uint8_t *payload = NULL, *raw = NULL;
+    size_t capacity = 0;
+    if (!err && length) {
+        raw = malloc(reader.block_size);
+        if (!raw) err = HRLE_ERR_MEMORY;
+    }
+
+    size_t done = 0;
+    for (int block = err || !length ? 0 : container_find_block(&reader, offset); !err && done < length; block++) {
+        const ContainerIndexEntry *entry = &reader.index[block];
+        err = read_block(&reader, block, &payload, &capacity, raw);
+        if (err) break;
+
+        size_t from = offset + done - entry->raw_offset;
+        size_t count = entry->raw_size - from < length - done ? entry->raw_size - from : length - done;
+        memcpy(&output[done], &raw[from], count);
+        done += count;
+    }
+
+    free(raw);
+    free(payload);
+    container_reader_close(&reader);
+    return err;
+}
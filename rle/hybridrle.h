@@ -0,0 +1,157 @@
+#ifndef HYBRIDRLE_H
+#define HYBRIDRLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+libhybridrle: the rle/ codecs behind one C API
+
+everything produced here is the block container described in container.h,
+so buffers written by hrle_compress can be read back with the streaming
+decompressor and vice versa; every block carries a CRC-32 that is checked
+on the way out
+
+no function prints or exits; failures come back as HRLE_ERR_* codes
+*/
+
+#define HRLE_VERSION_MAJOR 1
+#define HRLE_VERSION_MINOR 0
+
+#define HRLE_DEFAULT_BLOCK_SIZE (1u << 20)
+#define HRLE_MAX_BLOCK_SIZE (64u << 20)
+
+// Codec ids, identical to the ids stored in the container
+enum {
+    HRLE_CODEC_RAW = 0,
+    HRLE_CODEC_HUFFMAN = 1,
+    HRLE_CODEC_BLOCK_RLE = 2,
+    HRLE_CODEC_BYTE_RLE = 3,
+    HRLE_CODEC_MTF_HUFFMAN = 4,
+    HRLE_CODEC_BWT = 5,
+    HRLE_CODEC_HUFFMAN_X4 = 6,
+    HRLE_CODEC_HUFFMAN_X16 = 7,
+    HRLE_CODEC_ANS = 8,
+    HRLE_CODEC_MTF_ANS = 9,
+    HRLE_CODEC_BWT_ANS = 10,
+    HRLE_CODEC_BWT_CM = 11
+};
+
+// Error codes, all negative
+enum {
+    HRLE_OK = 0,
+    HRLE_ERR_IO = -1,
+    HRLE_ERR_FORMAT = -2,    // not a container, or corrupt
+    HRLE_ERR_CHECKSUM = -3,
+    HRLE_ERR_MEMORY = -4,
+    HRLE_ERR_RANGE = -5      // bad argument, or output buffer too small
+};
+
+const char *hrle_codec_name(int codec);
+int hrle_codec_from_name(const char *name);  // HRLE_ERR_RANGE if unknown
+const char *hrle_error_string(int err);
+
+/*
+worker threads shared by every call: blocks are encoded and decoded that
+many at a time, and a single block splits its Huffman chunks over them;
+0 (the default) means one per online CPU, 1 runs everything on the caller;
+output is identical for every thread count
+*/
+void hrle_set_threads(int threads);
+int hrle_threads(void);
+
+/*
+windowed sub-blocks for the bwt codecs, shared by every call: blocks larger
+than `window` bytes are cut into sub-blocks of that size (at most 64, larger
+if need be), each its own BWT, which loses the contexts that cross them; 0
+(the default) sorts whole blocks, which compresses best. Windows below 64K
+are rounded up, and any block is decoded whatever window it was written with
+
+only the suffix array shrinks: each block being coded (one per thread)
+peaks at about 6 * block_size whole and 3 * block_size + 4 * window with
+sub-blocks, compressing or decoding, plus another block_size while
+compressing when a pre-BWT filter applies (16M blocks: 98M whole, 50M with
+1M windows)
+*/
+void hrle_set_bwt_window(uint32_t window);
+uint32_t hrle_bwt_window(void);
+
+// Filters the bwt codecs can run a block through before sorting it
+enum {
+    HRLE_FILTER_AUTO = -1,
+    HRLE_FILTER_NONE = 0,
+    HRLE_FILTER_DELTA = 1,      // byte differences, for images and other sampled data
+    HRLE_FILTER_TRANSPOSE = 2,  // fixed-width records stored column by column
+    HRLE_FILTER_LZP = 3         // long repeats replaced by their lengths
+};
+
+/*
+pre-BWT filter for the bwt codecs, shared by every call: HRLE_FILTER_AUTO
+(the default) tries each filter on a sample of every block and keeps the
+one that pays, if any; a filter id forces it on every block of 4 KiB or
+more, with a default parameter where the block shows none, and
+HRLE_FILTER_NONE turns filtering off. Decoding follows whatever each block
+was written with
+*/
+void hrle_set_bwt_filter(int filter);
+int hrle_bwt_filter(void);
+const char *hrle_filter_name(int filter);
+int hrle_filter_from_name(const char *name);  // HRLE_ERR_RANGE if unknown
+
+// Entropy coder choice for the codecs that come with Huffman and rANS variants
+enum {
+    HRLE_ENTROPY_FIXED = 0,     // every block with the codec asked for
+    HRLE_ENTROPY_AUTO = 1       // each block with the variant its histogram favours
+};
+
+/*
+entropy coder for huffman/ans, mtf-huffman/mtf-ans and bwt/bwt-ans, shared
+by every call: HRLE_ENTROPY_AUTO (off by default) estimates both coders'
+output from each block's histogram and codes the block with the smaller,
+recording the variant in its header, so decoding needs no setting
+*/
+void hrle_set_entropy(int mode);
+int hrle_entropy(void);
+
+// ----------------- Buffer API -----------------
+// block_size 0 selects HRLE_DEFAULT_BLOCK_SIZE
+size_t hrle_compress_bound(int codec, size_t size, uint32_t block_size);
+int hrle_compress(int codec, uint32_t block_size, const uint8_t *src, size_t src_size,
+                  uint8_t *dst, size_t dst_capacity, size_t *dst_size);
+
+int hrle_decompressed_size(const uint8_t *src, size_t src_size, uint64_t *size);
+int hrle_decompress(const uint8_t *src, size_t src_size, uint8_t *dst, size_t dst_capacity, size_t *dst_size);
+
+// ----------------- Stream API -----------------
+/*
+bounded memory: one raw and one encoded block per thread at a time
+
+    feed input and drain output until all input is consumed (feed may take
+    less than offered while output is waiting), then finish and drain until
+    nothing more comes out; hrle_dstream_finish reports a cut-short container
+*/
+typedef struct HrleCStream HrleCStream;
+typedef struct HrleDStream HrleDStream;
+
+HrleCStream *hrle_cstream_create(int codec, uint32_t block_size);  // NULL on bad codec or memory
+int hrle_cstream_feed(HrleCStream *stream, const uint8_t *input, size_t size, size_t *consumed);
+int hrle_cstream_drain(HrleCStream *stream, uint8_t *output, size_t capacity, size_t *produced);
+int hrle_cstream_finish(HrleCStream *stream);
+void hrle_cstream_free(HrleCStream *stream);
+
+HrleDStream *hrle_dstream_create(void);
+int hrle_dstream_feed(HrleDStream *stream, const uint8_t *input, size_t size, size_t *consumed);
+int hrle_dstream_drain(HrleDStream *stream, uint8_t *output, size_t capacity, size_t *produced);
+int hrle_dstream_finish(HrleDStream *stream);
+void hrle_dstream_free(HrleDStream *stream);
+
+// ----------------- File API -----------------
+// Streams in to out through fixed-size buffers; *written (optional) receives the bytes written
+int hrle_compress_file(int codec, uint32_t block_size, FILE *in, FILE *out, uint64_t *written);
+int hrle_decompress_file(FILE *in, FILE *out, uint64_t *written);
+
+// Random access on a seekable container file: decodes only the blocks overlapping [offset, offset + length)
+int hrle_decompress_range(FILE *file, uint64_t offset, size_t length, uint8_t *output);
+
+#endif
@@ -0,0 +1,91 @@
+#include <string.h>
+#include <immintrin.h>
+#include "mtf.h"
+
+/*
+after BWT nearly every MTF index is below 32, so the front 32 entries of
+the list get an AVX2 path (one compare + movemask to find a symbol, one
+in-register shift to move it) and deeper indices fall back to memmove, which
+is already vectorized and beats chunk-by-chunk shifting there
+*/
+#define MTF_FRONT 32
+
+typedef struct {
+    _Alignas(32) uint8_t bytes[256];
+} MtfList;
+
+static void mtf_init(MtfList *list) {
+    for (int i = 0; i < 256; i++) list->bytes[i] = i;
+}
+
+// Moves front[index] (index < MTF_FRONT) to lane 0, lanes 0..index-1 move up one
+static inline __m256i mtf_shift_front(__m256i front, int index, uint8_t symbol) {
+    const __m256i lanes = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                           16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    // [symbol..., front.lo] then a 15-byte alignr gives each lane its predecessor, lane 0 gets the symbol
+    __m256i carry = _mm256_permute2x128_si256(front, _mm256_set1_epi8(symbol), 0x03);
+    __m256i shifted = _mm256_alignr_epi8(front, carry, 15);
+    __m256i mask = _mm256_cmpgt_epi8(_mm256_set1_epi8(index + 1), lanes);
+    return _mm256_blendv_epi8(front, shifted, mask);
+}
+
+// Deep indices: plain move of the list prefix
+static inline void mtf_move_deep(MtfList *list, int index, uint8_t symbol) {
+    memmove(list->bytes + 1, list->bytes, index);
+    list->bytes[0] = symbol;
+}
+
+// ----------------- Move-to-Front (MTF) Encoding -----------------
+void mtf_encode(const uint8_t *input, uint8_t *output, size_t size) {
+    MtfList list;
+    mtf_init(&list);
+
+    // The front chunk stays in a register; memory is only synced for deep moves
+    __m256i front = _mm256_load_si256((const __m256i*)list.bytes);
+    for (size_t i = 0; i < size; i++) {
+        uint8_t symbol = input[i];
+        if ((uint8_t)_mm256_cvtsi256_si32(front) == symbol) {  // Already in front, the common case after BWT
+            output[i] = 0;
+            continue;
+        }
+
+        __m256i target = _mm256_set1_epi8(symbol);
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(front, target));
+        if (mask) {
+            int index = __builtin_ctz(mask);
+            output[i] = index;
+            front = mtf_shift_front(front, index, symbol);
+            continue;
+        }
+
+        _mm256_store_si256((__m256i*)list.bytes, front);
+        int index = MTF_FRONT;
+        for (;; index += 32) {
+            __m256i block = _mm256_load_si256((const __m256i*)&list.bytes[index]);
+            mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, target));
+            if (mask) break;
+        }
+        index += __builtin_ctz(mask);
+        output[i] = index;
+        mtf_move_deep(&list, index, symbol);
+        front = _mm256_load_si256((const __m256i*)list.bytes);
+    }
+}
+
+// ----------------- Move-to-Front (MTF) Decoding -----------------
+void mtf_decode(const uint8_t *input, uint8_t *output, size_t size) {
+    MtfList list;
+    mtf_init(&list);
+
+    for (size_t i = 0; i < size; i++) {
+        uint8_t index = input[i];
+        uint8_t symbol = list.bytes[index];
+        output[i] = symbol;
+        if (index >= MTF_FRONT) {
+            mtf_move_deep(&list, index, symbol);
+        } else if (index) {
+            __m256i front = _mm256_load_si256((const __m256i*)list.bytes);
+            _mm256_store_si256((__m256i*)list.bytes, mtf_shift_front(front, index, symbol));
+        }
+    }
+}
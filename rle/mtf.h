@@ -0,0 +1,12 @@
+#ifndef MTF_H
+#define MTF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ----------------- Move-to-Front -----------------
+// Each byte becomes its index in a list of recently seen bytes (most recent first); output may alias input
+void mtf_encode(const uint8_t *input, uint8_t *output, size_t size);
+void mtf_decode(const uint8_t *input, uint8_t *output, size_t size);
+
+#endif
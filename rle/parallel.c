@@ -0,0 +1,148 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "parallel.h"
+
+static int configured_threads;  // 0 = one per online CPU
+static __thread int in_worker;   // set while running tasks of a parallel batch
+
+int parallel_threads(void) {
+    int threads = __atomic_load_n(&configured_threads, __ATOMIC_RELAXED);
+    if (threads > 0) return threads;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? (int)online : 1;
+}
+
+void parallel_set_threads(int threads) {
+    __atomic_store_n(&configured_threads, threads > 0 ? threads : 0, __ATOMIC_RELAXED);
+}
+
+int parallel_width(void) {
+    return in_worker ? 1 : parallel_threads();
+}
+
+// ----------------- Task Batches -----------------
+typedef struct Batch {
+    void *(*fn)(void *);
+    uint8_t *tasks;
+    size_t task_size;
+    int count;
+    int next;     // next unclaimed task
+    int workers;  // most workers allowed on the batch, the caller included
+    int joined;   // workers currently on it, the caller included
+    struct Batch *link;
+} Batch;
+
+// Workers claim tasks one at a time, so a slow task doesn't hold up a whole batch
+static void drain(Batch *batch) {
+    for (;;) {
+        int i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+        if (i >= batch->count) break;
+        batch->fn(batch->tasks + (size_t)i * batch->task_size);
+    }
+}
+
+// ----------------- Worker Pool -----------------
+/*
+helpers are started on first use and then live for the whole process,
+sleeping until a batch is posted, which wakes one helper per task it can
+hand out; every open batch sits on one list and an idle helper joins the first one that still has unclaimed tasks and room,
+so concurrent callers share the pool instead of each spawning threads
+*/
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_work = PTHREAD_COND_INITIALIZER;  // a batch was posted
+static pthread_cond_t pool_left = PTHREAD_COND_INITIALIZER;  // a helper left a batch
+static Batch *pool_batches;
+static int pool_size;  // helpers started
+
+static Batch *pool_find(void) {
+    for (Batch *batch = pool_batches; batch; batch = batch->link) {
+        if (batch->joined < batch->workers && __atomic_load_n(&batch->next, __ATOMIC_RELAXED) < batch->count) {
+            return batch;
+        }
+    }
+    return NULL;
+}
+
+static void *pool_helper(void *arg) {
+    (void)arg;
+    in_worker = 1;
+    pthread_mutex_lock(&pool_lock);
+    for (;;) {
+        Batch *batch = pool_find();
+        if (!batch) {
+            pthread_cond_wait(&pool_work, &pool_lock);
+            continue;
+        }
+        batch->joined++;
+        pthread_mutex_unlock(&pool_lock);
+
+        drain(batch);
+
+        pthread_mutex_lock(&pool_lock);
+        if (--batch->joined == 1) pthread_cond_broadcast(&pool_left);
+    }
+    return NULL;
+}
+
+// Helpers that fail to start are simply not there; callers drain their batches regardless
+static void pool_grow(int helpers) {
+    pthread_attr_t attr;
+    if (pthread_attr_init(&attr) != 0) return;
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    while (pool_size < helpers) {
+        pthread_t thread;
+        if (pthread_create(&thread, &attr, pool_helper, NULL) != 0) break;
+        pool_size++;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// A forked child has none of the parent's helpers, it starts its own on first use
+static void pool_after_fork(void) {
+    pthread_mutex_init(&pool_lock, NULL);
+    pthread_cond_init(&pool_work, NULL);
+    pthread_cond_init(&pool_left, NULL);
+    pool_batches = NULL;
+    pool_size = 0;
+}
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+static void pool_init(void) {
+    pthread_atfork(NULL, NULL, pool_after_fork);
+}
+
+void parallel_run(void *(*fn)(void *), void *tasks, size_t task_size, int count) {
+    Batch batch = { .fn = fn, .tasks = tasks, .task_size = task_size, .count = count, .next = 0 };
+    // Tasks started from inside a parallel batch run inline: the outer batch already keeps every CPU busy
+    batch.workers = parallel_width();
+    if (batch.workers > count) batch.workers = count;
+    if (batch.workers <= 1) {
+        for (int i = 0; i < count; i++) fn((uint8_t *)tasks + (size_t)i * task_size);
+        return;
+    }
+
+    pthread_once(&pool_once, pool_init);
+    pthread_mutex_lock(&pool_lock);
+    pool_grow(batch.workers - 1);
+    batch.joined = 1;
+    batch.link = pool_batches;
+    pool_batches = &batch;
+    // Only as many helpers as the batch can take; waking the rest would just send them back to sleep
+    for (int i = 1; i < batch.workers; i++) pthread_cond_signal(&pool_work);
+    pthread_mutex_unlock(&pool_lock);
+
+    in_worker = 1;
+    drain(&batch);
+    in_worker = 0;
+
+    // Every task is claimed now; wait for helpers still running theirs
+    pthread_mutex_lock(&pool_lock);
+    Batch **link = &pool_batches;
+    while (*link != &batch) link = &(*link)->link;
+    *link = batch.link;
+    while (batch.joined > 1) pthread_cond_wait(&pool_left, &pool_lock);
+    pthread_mutex_unlock(&pool_lock);
+}
@@ -0,0 +1,19 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+// ----------------- Parallel Tasks -----------------
+int parallel_threads(void);               // worker count, one per online CPU unless configured
+void parallel_set_threads(int threads);   // 0 restores the default
+int parallel_width(void);                 // workers a parallel_run from this thread would get, 1 inside a batch
+
+/*
+calls fn on each of `count` tasks laid out task_size bytes apart, using up to
+parallel_threads() workers (the caller is one of them); returns when all are done.
+helpers come from a process-wide pool started on first use and reused by every
+later call, from any thread
+*/
+void parallel_run(void *(*fn)(void *), void *tasks, size_t task_size, int count);
+
+#endif
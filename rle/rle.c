@@ -0,0 +1,466 @@
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+#include "container.h"
+#include "parallel.h"
+#include "rle.h"
+
+// ----------------- SIMD Block Compression -----------------
+size_t block_rle_bound(size_t size) {
+    // Every block raw, plus the partial block header
+    return BLOCK_RLE_HEADER_SIZE + size + size / BLOCK_RLE_SIZE + 2;
+}
+
+// Bit i set when byte i repeats byte i - 1 (bit 0 never is)
+static inline uint32_t repeat_mask(__m256i block) {
+    __m256i carry = _mm256_permute2x128_si256(block, block, 0x08);  // [zero, block.lo]
+    __m256i previous = _mm256_alignr_epi8(block, carry, 15);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, previous)) & ~1u;
+}
+
+/*
+splits a block into run and literal segments: runs of BLOCK_RLE_MIN_RUN or
+more bytes become run segments, everything between them one literal
+segment; returns the encoded size (at most 1 + BLOCK_RLE_SIZE)
+*/
+static size_t encode_segments(const uint8_t *src, uint32_t repeat, uint8_t *output) {
+    size_t out_pos = 0;
+    int literal_start = 0;
+    int pos = 0;
+    while (pos < BLOCK_RLE_SIZE) {
+        // Run at pos: itself plus the repeats right after it
+        uint64_t differ = ~((uint64_t)repeat >> (pos + 1));
+        int run = 1 + __builtin_ctzll(differ);
+        if (run < BLOCK_RLE_MIN_RUN) {
+            pos += run;
+            continue;
+        }
+
+        if (literal_start < pos) {
+            output[out_pos++] = BLOCK_RLE_SEGMENT_LITERAL | (pos - literal_start - 1);
+            memcpy(&output[out_pos], &src[literal_start], pos - literal_start);
+            out_pos += pos - literal_start;
+        }
+        output[out_pos++] = BLOCK_RLE_SEGMENT_RUN | (run - 1);
+        output[out_pos++] = src[pos];
+        pos += run;
+        literal_start = pos;
+    }
+    if (literal_start < BLOCK_RLE_SIZE) {
+        output[out_pos++] = BLOCK_RLE_SEGMENT_LITERAL | (BLOCK_RLE_SIZE - literal_start - 1);
+        memcpy(&output[out_pos], &src[literal_start], BLOCK_RLE_SIZE - literal_start);
+        out_pos += BLOCK_RLE_SIZE - literal_start;
+    }
+    return out_pos;
+}
+
+size_t block_rle_compress(const uint8_t *input, size_t size, uint8_t *output) {
+    size_t blocks = size / BLOCK_RLE_SIZE;
+    put_le64(output, size);
+    put_le64(output + 8, (size + BLOCK_RLE_SIZE - 1) / BLOCK_RLE_SIZE);
+    size_t out_pos = BLOCK_RLE_HEADER_SIZE;
+
+    for (size_t i = 0; i < blocks; i++) {
+        const uint8_t *src = &input[i * BLOCK_RLE_SIZE];
+        uint32_t repeat = repeat_mask(_mm256_loadu_si256((const __m256i*)src));
+
+        if (repeat == ~1u) {  // All bytes identical
+            output[out_pos++] = BLOCK_RLE_UNIFORM;
+            output[out_pos++] = src[0];
+            continue;
+        }
+
+        /*
+        cost model: uniform 2 bytes, raw 33, segmented 1 + segment headers +
+        literals + 1 per run; without any 3-byte run segmenting cannot win,
+        which settles most blocks of non-repetitive data with one AND
+        */
+        if (repeat & (repeat >> 1)) {
+            uint8_t segments[2 * BLOCK_RLE_SIZE];
+            size_t segmented = encode_segments(src, repeat, segments);
+            if (1 + segmented < 1 + BLOCK_RLE_SIZE) {
+                output[out_pos++] = BLOCK_RLE_SEGMENTED;
+                memcpy(&output[out_pos], segments, segmented);
+                out_pos += segmented;
+                continue;
+            }
+        }
+
+        output[out_pos++] = BLOCK_RLE_RAW;
+        memcpy(&output[out_pos], src, BLOCK_RLE_SIZE);
+        out_pos += BLOCK_RLE_SIZE;
+    }
+
+    // Handle remaining bytes (non-block aligned)
+    size_t remaining = size % BLOCK_RLE_SIZE;
+    if (remaining > 0) {
+        output[out_pos++] = BLOCK_RLE_PARTIAL;
+        output[out_pos++] = remaining;
+        memcpy(&output[out_pos], &input[blocks * BLOCK_RLE_SIZE], remaining);
+        out_pos += remaining;
+    }
+
+    return out_pos;
+}
+
+// ----------------- Block Decompression -----------------
+int block_rle_decoded_size(const uint8_t *input, size_t input_size, uint64_t *size) {
+    if (input_size < BLOCK_RLE_HEADER_SIZE) return CONTAINER_ERR_FORMAT;
+    uint64_t decoded = get_le64(input);
+    uint64_t blocks = get_le64(input + 8);
+    if (blocks != decoded / BLOCK_RLE_SIZE + (decoded % BLOCK_RLE_SIZE != 0)) return CONTAINER_ERR_FORMAT;
+
+    // Every block costs at least two bytes, which caps what a short input can claim
+    if (blocks > (input_size - BLOCK_RLE_HEADER_SIZE) / 2) return CONTAINER_ERR_FORMAT;
+    *size = decoded;
+    return CONTAINER_OK;
+}
+
+/*
+decodes one full block into dst, returns the input consumed or 0 if the
+block is malformed; `wide` promises BLOCK_RLE_SLACK readable bytes past
+`avail` bytes of input and writable bytes past dst's block,
+so runs and literals are single 32-byte stores that may spill into the next
+block (which overwrites them)
+*/
+static inline size_t decode_block(const uint8_t *input, size_t avail, uint8_t *dst, int wide) {
+    uint8_t marker = input[0];
+    if (marker == BLOCK_RLE_UNIFORM) {
+        if (avail < 2) return 0;
+        _mm256_storeu_si256((__m256i*)dst, _mm256_set1_epi8(input[1]));
+        return 2;
+    }
+    if (marker == BLOCK_RLE_RAW) {
+        if (avail < 1 + BLOCK_RLE_SIZE) return 0;
+        _mm256_storeu_si256((__m256i*)dst, _mm256_loadu_si256((const __m256i*)&input[1]));
+        return 1 + BLOCK_RLE_SIZE;
+    }
+    if (marker != BLOCK_RLE_SEGMENTED) return 0;
+
+    size_t in_pos = 1;
+    int filled = 0;
+    while (filled < BLOCK_RLE_SIZE) {
+        if (in_pos == avail) return 0;
+        uint8_t header = input[in_pos++];
+        int length = (header & BLOCK_RLE_SEGMENT_LENGTH) + 1;
+        if ((header & ~(BLOCK_RLE_SEGMENT_RUN | BLOCK_RLE_SEGMENT_LENGTH)) || length > BLOCK_RLE_SIZE - filled) return 0;
+
+        int run = header & BLOCK_RLE_SEGMENT_RUN;
+        size_t payload = run ? 1 : length;
+        if (payload > avail - in_pos) return 0;
+        if (wide && run) {
+            _mm256_storeu_si256((__m256i*)&dst[filled], _mm256_set1_epi8(input[in_pos]));
+        } else if (wide) {
+            _mm256_storeu_si256((__m256i*)&dst[filled], _mm256_loadu_si256((const __m256i*)&input[in_pos]));
+        } else if (run) {
+            memset(&dst[filled], input[in_pos], length);
+        } else {
+            memcpy(&dst[filled], &input[in_pos], length);
+        }
+        in_pos += payload;
+        filled += length;
+    }
+    return in_pos;
+}
+
+int block_rle_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    uint64_t decoded;
+    int err = block_rle_decoded_size(input, input_size, &decoded);
+    if (err) return err;
+    if (decoded != size) return CONTAINER_ERR_FORMAT;
+
+    // The header fixed the output size, so only the input can run out from here on
+    size_t in_pos = BLOCK_RLE_HEADER_SIZE;
+    size_t blocks = size / BLOCK_RLE_SIZE;
+    size_t wide_blocks = size >= BLOCK_RLE_SLACK ? (size - BLOCK_RLE_SLACK) / BLOCK_RLE_SIZE + 1 : 0;
+    for (size_t b = 0; b < blocks; b++) {
+        if (in_pos == input_size) return CONTAINER_ERR_FORMAT;
+        size_t avail = input_size - in_pos;
+        // A block takes at most BLOCK_RLE_MAX_BLOCK bytes (marker and 32 one-byte segments)
+        int wide = b < wide_blocks && avail >= BLOCK_RLE_MAX_BLOCK + BLOCK_RLE_SLACK;
+        if (wide) avail = BLOCK_RLE_MAX_BLOCK;
+        size_t used = decode_block(&input[in_pos], avail, &output[b * BLOCK_RLE_SIZE], wide);
+        if (!used) return CONTAINER_ERR_FORMAT;
+        in_pos += used;
+    }
+
+    size_t remaining = size % BLOCK_RLE_SIZE;
+    if (remaining > 0) {
+        if (input_size - in_pos < 2 || input[in_pos] != BLOCK_RLE_PARTIAL || input[in_pos + 1] != remaining ||
+            input_size - in_pos - 2 < remaining) {
+            return CONTAINER_ERR_FORMAT;
+        }
+        memcpy(&output[blocks * BLOCK_RLE_SIZE], &input[in_pos + 2], remaining);
+        in_pos += 2 + remaining;
+    }
+
+    return in_pos == input_size ? CONTAINER_OK : CONTAINER_ERR_FORMAT;
+}
+
+// ----------------- Chunked Block RLE -----------------
+static size_t chunk_count(size_t size) {
+    return (size + BLOCK_RLE_CHUNK_SIZE - 1) / BLOCK_RLE_CHUNK_SIZE;
+}
+
+size_t block_rle_chunked_bound(size_t size) {
+    return 8 + chunk_count(size) * (4 + block_rle_bound(BLOCK_RLE_CHUNK_SIZE));
+}
+
+typedef struct {
+    const uint8_t *input;
+    size_t input_size;
+    uint8_t *output;
+    size_t output_size;
+    int err;
+} ChunkTask;
+
+static void *decompress_chunk_task(void *arg) {
+    ChunkTask *task = arg;
+    task->err = block_rle_decompress(task->input, task->input_size, task->output, task->output_size);
+    return NULL;
+}
+
+// One worker's share of a wave: copy out what it staged last wave, then stage its next chunk
+typedef struct {
+    const uint8_t *input;      // chunk to encode, NULL once they run out
+    size_t input_size;
+    uint8_t *staging;          // slot the chunk is encoded into
+    size_t staged_size;
+    const uint8_t *previous;   // last wave's slot, NULL if there is nothing to copy
+    size_t previous_size;
+    uint8_t *destination;      // its place in the output
+} WaveTask;
+
+static void *wave_task(void *arg) {
+    WaveTask *task = arg;
+    if (task->previous) memcpy(task->destination, task->previous, task->previous_size);
+    if (task->input) task->staged_size = block_rle_compress(task->input, task->input_size, task->staging);
+    return NULL;
+}
+
+/*
+chunks are encoded a wave at a time, one per worker, into two sets of
+per-worker slots used in turn; a chunk's place in the output is known once
+the wave that encoded it is done, so the next wave copies it there while
+encoding into the other set. Staging stays at 2 slots per worker, small
+enough to stay in cache, whatever the block size
+*/
+int block_rle_compress_chunked(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size) {
+    size_t chunks = chunk_count(size);
+    size_t workers = parallel_width();
+    if (workers > chunks) workers = chunks ? chunks : 1;
+    size_t slot = block_rle_bound(BLOCK_RLE_CHUNK_SIZE);
+    WaveTask *tasks = calloc(workers, sizeof(WaveTask));
+    uint8_t *staging = malloc(2 * workers * slot);
+    if (!tasks || !staging) {
+        free(tasks);
+        free(staging);
+        return CONTAINER_ERR_MEMORY;
+    }
+
+    // Index of encoded sizes, then the chunks back to back behind it
+    put_le32(output, chunks);
+    put_le32(output + 4, BLOCK_RLE_CHUNK_SIZE);
+    size_t out_pos = 8 + 4 * chunks;
+    for (size_t first = 0; first < chunks + workers; first += workers) {
+        uint8_t *slots = staging + (first / workers % 2) * workers * slot;
+        int count = 0;
+        for (size_t t = 0; t < workers; t++) {
+            WaveTask *task = &tasks[t];
+            size_t i = first + t;
+            task->previous = NULL;
+            if (first >= workers && i - workers < chunks) {
+                task->previous = task->staging;
+                task->previous_size = task->staged_size;
+                task->destination = &output[out_pos];
+                put_le32(output + 8 + 4 * (i - workers), task->staged_size);
+                out_pos += task->staged_size;
+            }
+            task->input = NULL;
+            if (i < chunks) {
+                size_t start = i * BLOCK_RLE_CHUNK_SIZE;
+                task->input = &input[start];
+                task->input_size = size - start < BLOCK_RLE_CHUNK_SIZE ? size - start : BLOCK_RLE_CHUNK_SIZE;
+            }
+            task->staging = &slots[t * slot];
+            if (task->previous || task->input) count = t + 1;
+        }
+        parallel_run(wave_task, tasks, sizeof(WaveTask), count);
+    }
+
+    *output_size = out_pos;
+    free(staging);
+    free(tasks);
+    return CONTAINER_OK;
+}
+
+int block_rle_decompress_chunked(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    size_t chunks = chunk_count(size);
+    if (input_size < 8 || get_le32(input) != chunks || get_le32(input + 4) != BLOCK_RLE_CHUNK_SIZE ||
+        (input_size - 8) / 4 < chunks) {
+        return CONTAINER_ERR_FORMAT;
+    }
+
+    ChunkTask *tasks = malloc((chunks ? chunks : 1) * sizeof(ChunkTask));
+    if (!tasks) return CONTAINER_ERR_MEMORY;
+
+    // Offsets from the index let every chunk start decoding at once
+    size_t in_pos = 8 + 4 * chunks;
+    int err = CONTAINER_OK;
+    for (size_t i = 0; i < chunks && !err; i++) {
+        size_t encoded = get_le32(input + 8 + 4 * i);
+        size_t start = i * BLOCK_RLE_CHUNK_SIZE;
+        if (encoded > input_size - in_pos) err = CONTAINER_ERR_FORMAT;
+        tasks[i].input = &input[in_pos];
+        tasks[i].input_size = encoded;
+        tasks[i].output = &output[start];
+        tasks[i].output_size = size - start < BLOCK_RLE_CHUNK_SIZE ? size - start : BLOCK_RLE_CHUNK_SIZE;
+        in_pos += encoded;
+    }
+    if (!err && in_pos != input_size) err = CONTAINER_ERR_FORMAT;
+
+    if (!err) {
+        parallel_run(decompress_chunk_task, tasks, sizeof(ChunkTask), chunks);
+        for (size_t i = 0; i < chunks && !err; i++) err = tasks[i].err;
+    }
+    free(tasks);
+    return err;
+}
+
+// ----------------- Byte RLE -----------------
+size_t byte_rle_bound(size_t size) {
+    return 2 * size;  // runs of one byte; longer runs never need more than their length
+}
+
+/*
+length of the run of input[pos] starting at pos: whole windows are compared
+against a broadcast of the byte and the first mismatch comes from tzcnt of
+the inverted mask, so a run costs one compare per 32 (or 64) bytes
+*/
+static inline size_t run_length(const uint8_t *input, size_t pos, size_t size) {
+    uint8_t value = input[pos];
+    size_t end = pos + 1;
+#ifdef __AVX512BW__
+    __m512i target512 = _mm512_set1_epi8(value);
+    while (end + 64 <= size) {
+        __mmask64 differ = _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(&input[end]), target512);
+        if (differ) return end + __builtin_ctzll(differ) - pos;
+        end += 64;
+    }
+#endif
+    __m256i target = _mm256_set1_epi8(value);
+    while (end + 32 <= size) {
+        __m256i window = _mm256_loadu_si256((const __m256i*)&input[end]);
+        uint32_t differ = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(window, target));
+        if (differ) return end + __builtin_ctz(differ) - pos;
+        end += 32;
+    }
+    while (end < size && input[end] == value) end++;
+    return end - pos;
+}
+
+size_t byte_rle_compress(const uint8_t *input, size_t size, uint8_t *output) {
+    size_t out_pos = 0;
+    size_t i = 0;
+    while (i < size) {
+        size_t run = run_length(input, i, size);
+        output[out_pos++] = input[i];
+
+        // Run length - 1 as a varint: 7 bits per byte, low bits first, high bit = more follows
+        size_t extra = run - 1;
+        while (extra >= 0x80) {
+            output[out_pos++] = (uint8_t)extra | 0x80;
+            extra >>= 7;
+        }
+        output[out_pos++] = (uint8_t)extra;
+        i += run;
+    }
+    return out_pos;
+}
+
+int byte_rle_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    size_t out_pos = 0;
+    size_t in_pos = 0;
+    while (in_pos < input_size) {
+        uint8_t value = input[in_pos++];
+
+        uint64_t extra = 0;
+        int shift = 0;
+        for (;;) {
+            if (in_pos == input_size || shift > 35) return CONTAINER_ERR_FORMAT;  // runs fit in a block
+            uint8_t byte = input[in_pos++];
+            extra |= (uint64_t)(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        if (extra >= size - out_pos) return CONTAINER_ERR_FORMAT;
+
+        memset(&output[out_pos], value, extra + 1);
+        out_pos += extra + 1;
+    }
+    return out_pos == size ? CONTAINER_OK : CONTAINER_ERR_FORMAT;
+}
+
+// ----------------- Zero-Run Coding -----------------
+size_t zero_rle_bound(size_t size) {
+    return 2 * size;  // every index 254 or 255
+}
+
+size_t zero_rle_encode(const uint8_t *input, size_t size, uint8_t *output) {
+    size_t out_pos = 0;
+    size_t i = 0;
+    while (i < size) {
+        if (input[i] == 0) {
+            size_t run = 0;
+            while (i < size && input[i] == 0) run++, i++;
+
+            // n = sum of digit_k * 2^k with digits 1 (RUNA) and 2 (RUNB)
+            while (run > 0) {
+                run--;
+                output[out_pos++] = run & 1 ? ZERO_RLE_RUNB : ZERO_RLE_RUNA;
+                run >>= 1;
+            }
+            continue;
+        }
+
+        uint8_t index = input[i++];
+        if (index < 254) {
+            output[out_pos++] = index + 1;
+        } else {
+            output[out_pos++] = ZERO_RLE_ESCAPE;
+            output[out_pos++] = index - 254;
+        }
+    }
+    return out_pos;
+}
+
+int zero_rle_decode(const uint8_t *input, size_t input_size, uint8_t *output, size_t size) {
+    size_t out_pos = 0;
+    size_t in_pos = 0;
+    while (in_pos < input_size) {
+        uint8_t symbol = input[in_pos];
+        if (symbol <= ZERO_RLE_RUNB) {
+            // Sum the digits of the whole run before writing it
+            size_t run = 0;
+            size_t weight = 1;
+            while (in_pos < input_size && input[in_pos] <= ZERO_RLE_RUNB) {
+                run += (input[in_pos++] + 1) * weight;
+                if (run > size - out_pos) return CONTAINER_ERR_FORMAT;
+                weight <<= 1;
+            }
+            memset(&output[out_pos], 0, run);
+            out_pos += run;
+            continue;
+        }
+
+        if (out_pos == size) return CONTAINER_ERR_FORMAT;
+        in_pos++;
+        if (symbol != ZERO_RLE_ESCAPE) {
+            output[out_pos++] = symbol - 1;
+        } else {
+            if (in_pos == input_size || input[in_pos] > 1) return CONTAINER_ERR_FORMAT;
+            output[out_pos++] = 254 + input[in_pos++];
+        }
+    }
+    return out_pos == size ? CONTAINER_OK : CONTAINER_ERR_FORMAT;
+}
@@ -0,0 +1,85 @@
+#ifndef RLE_H
+#define RLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ----------------- SIMD Block RLE -----------------
+/*
+header: decoded size and block count (u64 little-endian each), then the
+input cut into 32-byte blocks (one AVX2 register), each coded the cheapest
+of three ways:
+    0x00 value          block of 32 identical bytes
+    0x01 <segments>     runs and literals, covering exactly 32 bytes
+    0xFF <32 bytes>     block stored as is
+    0xFE count <bytes>  final partial block of count < 32 bytes
+a segment header is 0x80 | (length - 1) followed by the run byte, or
+length - 1 followed by length literal bytes; a block is only segmented when
+that is smaller than storing it, so output never exceeds 33/32 of the input
+*/
+#define BLOCK_RLE_SIZE 32
+#define BLOCK_RLE_MIN_RUN 3  // shorter runs stay inside literals
+#define BLOCK_RLE_HEADER_SIZE 16
+#define BLOCK_RLE_MAX_BLOCK (1 + 2 * BLOCK_RLE_SIZE)  // largest valid encoding of one block
+#define BLOCK_RLE_SLACK 64   // bytes the decoder's wide stores and loads may run past a block
+
+#define BLOCK_RLE_UNIFORM 0x00
+#define BLOCK_RLE_SEGMENTED 0x01
+#define BLOCK_RLE_RAW 0xFF
+#define BLOCK_RLE_PARTIAL 0xFE
+
+#define BLOCK_RLE_SEGMENT_RUN 0x80
+#define BLOCK_RLE_SEGMENT_LITERAL 0x00
+#define BLOCK_RLE_SEGMENT_LENGTH 0x1F  // length - 1
+
+size_t block_rle_bound(size_t size);
+size_t block_rle_compress(const uint8_t *input, size_t size, uint8_t *output);
+int block_rle_decoded_size(const uint8_t *input, size_t input_size, uint64_t *size);  // from the header, for sizing output
+
+// Checks every marker and segment against the input left and the size in the header; never writes past size
+int block_rle_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+// ----------------- Chunked Block RLE -----------------
+/*
+the codec's framing: the input is cut into BLOCK_RLE_CHUNK_SIZE chunks,
+each an independent block RLE stream coded on its own worker
+(parallel.h); an index of encoded chunk sizes lets decoding start every
+chunk at once
+    chunk count (u32), chunk size (u32), encoded size per chunk (u32 each),
+    chunk streams back to back
+all integers little-endian
+*/
+#define BLOCK_RLE_CHUNK_SIZE (256u << 10)
+
+size_t block_rle_chunked_bound(size_t size);
+int block_rle_compress_chunked(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size);
+int block_rle_decompress_chunked(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+// ----------------- Byte RLE -----------------
+/*
+(byte, run length - 1 as a LEB128 varint) pairs; runs are found with AVX2
+compares (AVX-512 when built with -mavx512bw), so long runs cost one
+compare per window
+*/
+size_t byte_rle_bound(size_t size);
+size_t byte_rle_compress(const uint8_t *input, size_t size, uint8_t *output);
+int byte_rle_decompress(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+// ----------------- Zero-Run Coding -----------------
+/*
+bzip2-style coding of MTF output: a run of n zeros is written as n in
+bijective base 2 with the digits RUNA (1) and RUNB (2), least significant
+first, so runs cost about log2(n) symbols; everything else moves up one:
+    0x00 RUNA, 0x01 RUNB
+    0x02..0xFE  MTF index 1..253
+    0xFF x      MTF index 254 + x (x is 0 or 1)
+*/
+#define ZERO_RLE_RUNA 0x00
+#define ZERO_RLE_RUNB 0x01
+#define ZERO_RLE_ESCAPE 0xFF
+
+size_t zero_rle_bound(size_t size);
+size_t zero_rle_encode(const uint8_t *input, size_t size, uint8_t *output);
+int zero_rle_decode(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+
+#endif
@@ -0,0 +1,43 @@
+#include <stdlib.h>
+#include <string.h>
+#include "container.h"
+#include "parallel.h"
+#include "sais.h"
+
+#define SAIS_READAHEAD (1 << 16)  // suffixes per worker in one read-ahead block
+
+// ----------------- Suffix Types -----------------
+// One bit per position: set for S-type (smaller than the suffix after it), clear for L-type
+static inline int is_s(const uint8_t *types, size_t i) {
+    return (types[i >> 3] >> (i & 7)) & 1;
+}
+
+static inline void set_s(uint8_t *types, size_t i) {
+    types[i >> 3] |= (uint8_t)(1u << (i & 7));
+}
+
+// Leftmost S: an S-type position right after an L-type one
+static inline int is_lms(const uint8_t *types, size_t i) {
+    return i > 0 && is_s(types, i) && !is_s(types, i - 1);
+}
+
+// ----------------- Index Widths -----------------
+#define SA_INT int32_t
+#define SA_NAME(name) name##32
+#include "sais_impl.h"
+#undef SA_INT
+#undef SA_NAME
+
+#define SA_INT int64_t
+#define SA_NAME(name) name##64
+#include "sais_impl.h"
+#undef SA_INT
+#undef SA_NAME
+
+int sais_sort32(const uint8_t *text, int32_t *sa, int32_t n) {
+    return sais_main32(text, 1, sa, n, 256);
+}
+
+int sais_sort64(const uint8_t *text, int64_t *sa, int64_t n) {
+    return sais_main64(text, 1, sa, n, 256);
+}
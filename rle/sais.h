@@ -0,0 +1,25 @@
+#ifndef SAIS_H
+#define SAIS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ----------------- Suffix Array (SA-IS) -----------------
+/*
+suffix sorting by induced sorting (Nong, Zhang and Chan), with the
+end-of-text sentinel implicit: sa receives the n suffix start positions of
+text in sorted order, a suffix sorting before every longer suffix it is a
+prefix of, so the text needs no terminator appended
+
+the top-level induction scans read ahead block by block on parallel_run
+workers, which take the random text lookups off the sequential pass that
+places suffixes; the 64-bit variant is for texts past INT32_MAX bytes
+
+returns CONTAINER_OK or CONTAINER_ERR_MEMORY
+*/
+#define SAIS_PARALLEL_MIN_SIZE (1u << 20)  // smaller texts sort on the calling thread
+
+int sais_sort32(const uint8_t *text, int32_t *sa, int32_t n);
+int sais_sort64(const uint8_t *text, int64_t *sa, int64_t n);
+
+#endif
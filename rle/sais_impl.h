@@ -0,0 +1,261 @@
+// ----------------- SA-IS for one index width -----------------
+/*
+included by sais.c once per width, with SA_INT the signed index type and
+SA_NAME(name) appending the width to every function; the top level sorts
+bytes (cs == 1), the recursion sorts SA_INT names (cs == sizeof(SA_INT))
+*/
+
+static inline SA_INT SA_NAME(symbol)(const void *s, int cs, SA_INT i) {
+    return cs == 1 ? ((const uint8_t *)s)[i] : ((const SA_INT *)s)[i];
+}
+
+// Start (end = 0) or one past the end (end = 1) of every symbol's bucket
+static void SA_NAME(buckets)(const SA_INT *count, SA_INT *bkt, SA_INT k, int end) {
+    SA_INT sum = 0;
+    for (SA_INT c = 0; c < k; c++) {
+        sum += count[c];
+        bkt[c] = end ? sum : sum - count[c];
+    }
+}
+
+// Occurrences of every symbol in s, followed by k more entries for bucket pointers; NULL without memory
+static SA_INT *SA_NAME(count_symbols)(const void *s, int cs, SA_INT n, SA_INT k) {
+    SA_INT *count = calloc((size_t)k * 2, sizeof(SA_INT));
+    if (!count) return NULL;
+    for (SA_INT i = 0; i < n; i++) count[SA_NAME(symbol)(s, cs, i)]++;
+    return count;
+}
+
+// ----------------- Read-Ahead -----------------
+/*
+a scan only ever writes ahead of itself, so within a block the entries
+already there can be looked up before the block is walked; entries written
+(or, in the S scan, overwritten) meanwhile no longer match their snapshot
+and are looked up again on the spot
+*/
+typedef struct {
+    const uint8_t *text;
+    const uint8_t *types;
+    const SA_INT *sa;
+    SA_INT begin, end, base;
+    int want_s;        // inducing S-type suffixes rather than L-type ones
+    SA_INT *snapshot;  // sa[i] as read
+    int16_t *symbol;   // bucket of the suffix sa[i] - 1 induces, -1 for none
+} SA_NAME(ReadAhead);
+
+static void *SA_NAME(read_ahead)(void *arg) {
+    SA_NAME(ReadAhead) *task = arg;
+    for (SA_INT i = task->begin; i < task->end; i++) {
+        SA_INT j = task->sa[i] - 1;
+        task->snapshot[i - task->base] = j + 1;
+        task->symbol[i - task->base] = j >= 0 && is_s(task->types, j) == task->want_s ? task->text[j] : -1;
+    }
+    return NULL;
+}
+
+typedef struct {
+    int workers;
+    SA_INT block;
+    SA_INT *snapshot;
+    int16_t *symbol;
+    SA_NAME(ReadAhead) *tasks;
+} SA_NAME(ReadAheadState);
+
+// Look up sa[begin..end) on the workers
+static void SA_NAME(read_block)(SA_NAME(ReadAheadState) *state, const uint8_t *text, const uint8_t *types,
+                                const SA_INT *sa, SA_INT begin, SA_INT end, int want_s) {
+    SA_INT per_task = (end - begin + state->workers - 1) / state->workers;
+    int count = 0;
+    for (SA_INT first = begin; first < end; first += per_task, count++) {
+        SA_NAME(ReadAhead) *task = &state->tasks[count];
+        task->text = text;
+        task->types = types;
+        task->sa = sa;
+        task->begin = first;
+        task->end = end - first < per_task ? end : first + per_task;
+        task->base = begin;
+        task->want_s = want_s;
+        task->snapshot = state->snapshot;
+        task->symbol = state->symbol;
+    }
+    parallel_run(SA_NAME(read_ahead), state->tasks, sizeof(state->tasks[0]), count);
+}
+
+static void SA_NAME(induce_l_blocks)(SA_NAME(ReadAheadState) *state, const uint8_t *text, const uint8_t *types,
+                                     SA_INT *sa, SA_INT n, SA_INT *bkt) {
+    for (SA_INT begin = 0; begin < n; begin += state->block) {
+        SA_INT end = n - begin < state->block ? n : begin + state->block;
+        SA_NAME(read_block)(state, text, types, sa, begin, end, 0);
+        for (SA_INT i = begin; i < end; i++) {
+            SA_INT v = sa[i];
+            if (v == state->snapshot[i - begin]) {
+                int c = state->symbol[i - begin];
+                if (c >= 0) sa[bkt[c]++] = v - 1;
+            } else if (v > 0 && !is_s(types, v - 1)) {
+                sa[bkt[text[v - 1]]++] = v - 1;
+            }
+        }
+    }
+}
+
+static void SA_NAME(induce_s_blocks)(SA_NAME(ReadAheadState) *state, const uint8_t *text, const uint8_t *types,
+                                     SA_INT *sa, SA_INT n, SA_INT *bkt) {
+    for (SA_INT end = n; end > 0; end -= state->block) {
+        SA_INT begin = end < state->block ? 0 : end - state->block;
+        SA_NAME(read_block)(state, text, types, sa, begin, end, 1);
+        for (SA_INT i = end - 1; i >= begin; i--) {
+            SA_INT v = sa[i];
+            if (v == state->snapshot[i - begin]) {
+                int c = state->symbol[i - begin];
+                if (c >= 0) sa[--bkt[c]] = v - 1;
+            } else if (v > 0 && is_s(types, v - 1)) {
+                sa[--bkt[text[v - 1]]] = v - 1;
+            }
+        }
+    }
+}
+
+// ----------------- Induced Sorting -----------------
+/*
+with the LMS suffixes in place at their bucket ends, a forward scan sorts
+the L-type suffixes and a backward scan the S-type ones; the implicit
+sentinel is the smallest suffix, so it seeds the L scan with the last
+position, always L-type
+*/
+static void SA_NAME(induce)(const void *s, int cs, const uint8_t *types, SA_INT *sa, SA_INT n,
+                            const SA_INT *count, SA_INT *bkt, SA_INT k) {
+    SA_NAME(ReadAheadState) state = { .workers = cs == 1 && (size_t)n >= SAIS_PARALLEL_MIN_SIZE ? parallel_width() : 1 };
+    if (state.workers > 1) {
+        state.block = (SA_INT)state.workers * SAIS_READAHEAD;
+        state.snapshot = malloc((size_t)state.block * sizeof(SA_INT));
+        state.symbol = malloc((size_t)state.block * sizeof(int16_t));
+        state.tasks = malloc((size_t)state.workers * sizeof(state.tasks[0]));
+        // Without the buffers the scans simply run on the caller alone
+        if (!state.snapshot || !state.symbol || !state.tasks) state.workers = 1;
+    }
+
+    SA_NAME(buckets)(count, bkt, k, 0);
+    sa[bkt[SA_NAME(symbol)(s, cs, n - 1)]++] = n - 1;
+    if (state.workers > 1) {
+        SA_NAME(induce_l_blocks)(&state, s, types, sa, n, bkt);
+    } else {
+        for (SA_INT i = 0; i < n; i++) {
+            SA_INT j = sa[i] - 1;
+            if (j >= 0 && !is_s(types, j)) sa[bkt[SA_NAME(symbol)(s, cs, j)]++] = j;
+        }
+    }
+
+    SA_NAME(buckets)(count, bkt, k, 1);
+    if (state.workers > 1) {
+        SA_NAME(induce_s_blocks)(&state, s, types, sa, n, bkt);
+    } else {
+        for (SA_INT i = n - 1; i >= 0; i--) {
+            SA_INT j = sa[i] - 1;
+            if (j >= 0 && is_s(types, j)) sa[--bkt[SA_NAME(symbol)(s, cs, j)]] = j;
+        }
+    }
+
+    free(state.tasks);
+    free(state.symbol);
+    free(state.snapshot);
+}
+
+static int SA_NAME(sais_main)(const void *s, int cs, SA_INT *sa, SA_INT n, SA_INT k) {
+    if (n == 0) return CONTAINER_OK;
+
+    uint8_t *types = calloc((size_t)n / 8 + 1, 1);
+    SA_INT *count = SA_NAME(count_symbols)(s, cs, n, k);
+    if (!types || !count) {
+        free(count);
+        free(types);
+        return CONTAINER_ERR_MEMORY;
+    }
+    SA_INT *bkt = count + k;
+
+    // The last position is L-type: the sentinel after it is smaller
+    SA_INT next = SA_NAME(symbol)(s, cs, n - 1);
+    int next_s = 0;
+    for (SA_INT i = n - 2; i >= 0; i--) {
+        SA_INT c = SA_NAME(symbol)(s, cs, i);
+        next_s = c < next || (c == next && next_s);
+        if (next_s) set_s(types, i);
+        next = c;
+    }
+
+    // Stage 1: sort the LMS substrings
+    SA_NAME(buckets)(count, bkt, k, 1);
+    for (SA_INT i = 0; i < n; i++) sa[i] = -1;
+    for (SA_INT i = 1; i < n; i++) {
+        if (is_lms(types, i)) sa[--bkt[SA_NAME(symbol)(s, cs, i)]] = i;
+    }
+    SA_NAME(induce)(s, cs, types, sa, n, count, bkt, k);
+
+    // Move them to the front in sorted order; there are at most n / 2
+    SA_INT n1 = 0;
+    for (SA_INT i = 0; i < n; i++) {
+        if (is_lms(types, sa[i])) sa[n1++] = sa[i];
+    }
+
+    /*
+    LMS positions are at least 2 apart, so pos / 2 gives each a free slot
+    past the sorted ones: first for the length of its substring (through the
+    next LMS position; 0 when it runs into the sentinel, which makes it
+    unique), then for its name. Equal lengths and symbols mean equal types,
+    so neighbours with both share a name
+    */
+    for (SA_INT i = n1; i < n; i++) sa[i] = -1;
+    for (SA_INT i = n - 1, end = n; i >= 1; i--) {
+        if (!is_lms(types, i)) continue;
+        sa[n1 + i / 2] = end == n ? 0 : end - i + 1;
+        end = i;
+    }
+    SA_INT names = 0, prev = -1, prev_length = 0;
+    for (SA_INT i = 0; i < n1; i++) {
+        SA_INT pos = sa[i], length = sa[n1 + pos / 2];
+        if (prev < 0 || length == 0 || length != prev_length ||
+            memcmp((const uint8_t *)s + (size_t)pos * cs, (const uint8_t *)s + (size_t)prev * cs, (size_t)length * cs)) {
+            names++;
+        }
+        prev = pos;
+        prev_length = length;
+        sa[n1 + pos / 2] = names - 1;
+    }
+    SA_INT *s1 = sa + n - n1;
+    for (SA_INT i = n - 1, j = n - 1; i >= n1; i--) {
+        if (sa[i] >= 0) sa[j--] = sa[i];
+    }
+
+    // Stage 2: sort the reduced string, recursing while names repeat
+    int err = CONTAINER_OK;
+    if (names < n1) {
+        // With up to n / 2 names the recursion's buckets can outweigh the text; ours are counted again after it
+        free(count);
+        count = NULL;
+        err = SA_NAME(sais_main)(s1, sizeof(SA_INT), sa, n1, names);
+        if (!err && !(count = SA_NAME(count_symbols)(s, cs, n, k))) err = CONTAINER_ERR_MEMORY;
+    } else {
+        for (SA_INT i = 0; i < n1; i++) sa[s1[i]] = i;
+    }
+
+    // Stage 3: place the sorted LMS suffixes at their bucket ends and induce the rest from them
+    if (!err) {
+        for (SA_INT i = 1, j = 0; i < n; i++) {
+            if (is_lms(types, i)) s1[j++] = i;
+        }
+        for (SA_INT i = 0; i < n1; i++) sa[i] = s1[sa[i]];
+        for (SA_INT i = n1; i < n; i++) sa[i] = -1;
+
+        bkt = count + k;
+        SA_NAME(buckets)(count, bkt, k, 1);
+        for (SA_INT i = n1 - 1; i >= 0; i--) {
+            SA_INT j = sa[i];
+            sa[i] = -1;
+            sa[--bkt[SA_NAME(symbol)(s, cs, j)]] = j;
+        }
+        SA_NAME(induce)(s, cs, types, sa, n, count, bkt, k);
+    }
+
+    free(count);
+    free(types);
+    return err;
+}
@@ -0,0 +1,448 @@
+#include <stdlib.h>
+#include <string.h>
+#include "stream.h"
+#include "parallel.h"
+
+enum {
+    DSTREAM_FILE_HEADER,
+    DSTREAM_BLOCK_HEADER,
+    DSTREAM_PAYLOAD,
+    DSTREAM_INDEX,
+    DSTREAM_FOOTER,
+    DSTREAM_DONE,
+    DSTREAM_ERROR
+};
+
+static size_t min_size(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+static void free_blocks(StreamBlock *blocks, int count) {
+    if (!blocks) return;
+    for (int i = 0; i < count; i++) {
+        free(blocks[i].raw);
+        free(blocks[i].data);
+    }
+    free(blocks);
+}
+
+// ----------------- Compression -----------------
+int cstream_init(CompressStream *stream, const StreamCodec *codec, uint32_t block_size, int threads) {
+    memset(stream, 0, sizeof(*stream));
+    if (block_size == 0 || block_size > CONTAINER_MAX_BLOCK_SIZE) return CONTAINER_ERR_RANGE;
+
+    stream->codec = codec;
+    stream->block_size = block_size;
+    stream->threads = threads > 0 ? threads : parallel_threads();
+
+    // The payload slot must hold either the codec output or the block stored raw
+    size_t payload_capacity = codec ? codec->bound(block_size) : block_size;
+    if (payload_capacity < block_size) payload_capacity = block_size;
+
+    stream->blocks = calloc(stream->threads, sizeof(StreamBlock));
+    stream->out_capacity = CONTAINER_FILE_HEADER_SIZE;
+    stream->out = malloc(stream->out_capacity);
+    if (!stream->blocks || !stream->out) return CONTAINER_ERR_MEMORY;
+
+    for (int i = 0; i < stream->threads; i++) {
+        StreamBlock *block = &stream->blocks[i];
+        block->raw = malloc(block_size);
+        block->data_capacity = CONTAINER_BLOCK_HEADER_SIZE + payload_capacity;
+        block->data = malloc(block->data_capacity);
+        if (!block->raw || !block->data) return CONTAINER_ERR_MEMORY;
+    }
+
+    container_put_file_header(stream->out, block_size);
+    stream->queue = stream->out;
+    stream->queue_size = CONTAINER_FILE_HEADER_SIZE;
+    stream->pos = CONTAINER_FILE_HEADER_SIZE;
+    return CONTAINER_OK;
+}
+
+// Encodes one raw block into its header + payload; runs on a worker
+static void *encode_block_task(void *arg) {
+    StreamBlock *block = arg;
+    uint8_t *payload = block->data + CONTAINER_BLOCK_HEADER_SIZE;
+    ContainerBlockHeader header = {
+        .codec = block->codec ? block->codec->id : CONTAINER_CODEC_RAW,
+        .raw_size = block->raw_size,
+        .checksum = crc32_update(0, block->raw, block->raw_size)
+    };
+
+    size_t payload_size = block->raw_size;
+    if (!block->codec) {
+        block->err = CONTAINER_OK;
+    } else if (block->codec->compress_select && stream_entropy() == STREAM_ENTROPY_AUTO) {
+        // The chosen variant shares the codec's bound, so the payload slot holds it either way
+        block->err = block->codec->compress_select(block->raw, block->raw_size, payload, &payload_size, &header.codec);
+    } else {
+        block->err = block->codec->compress(block->raw, block->raw_size, payload, &payload_size);
+    }
+    if (block->err) return NULL;
+    if (payload_size >= block->raw_size) {
+        // Incompressible: store the block raw so it never expands beyond the header
+        header.codec = CONTAINER_CODEC_RAW;
+        payload_size = block->raw_size;
+        memcpy(payload, block->raw, payload_size);
+    }
+    header.payload_size = payload_size;
+    container_put_block_header(block->data, &header);
+
+    block->header = header;
+    block->data_size = CONTAINER_BLOCK_HEADER_SIZE + payload_size;
+    return NULL;
+}
+
+// Encodes the first `count` blocks concurrently, then lays them out in order
+static int encode_batch(CompressStream *stream, int count) {
+    if (stream->block_count + count > stream->index_capacity) {
+        uint32_t capacity = stream->index_capacity ? stream->index_capacity : 64;
+        while (capacity < stream->block_count + count) capacity *= 2;
+        ContainerIndexEntry *index = realloc(stream->index, capacity * sizeof(ContainerIndexEntry));
+        if (!index) return CONTAINER_ERR_MEMORY;
+        stream->index = index;
+        stream->index_capacity = capacity;
+    }
+
+    for (int i = 0; i < count; i++) stream->blocks[i].codec = stream->codec;
+    parallel_run(encode_block_task, stream->blocks, sizeof(StreamBlock), count);
+
+    for (int i = 0; i < count; i++) {
+        const StreamBlock *block = &stream->blocks[i];
+        if (block->err) return block->err;
+
+        ContainerIndexEntry *entry = &stream->index[stream->block_count++];
+        entry->offset = stream->pos;
+        entry->raw_offset = stream->raw_total;
+        entry->raw_size = block->header.raw_size;
+        entry->payload_size = block->header.payload_size;
+
+        stream->pos += block->data_size;
+        stream->raw_total += block->raw_size;
+    }
+
+    stream->emit_count = count;
+    stream->emit_next = 0;
+    return CONTAINER_OK;
+}
+
+// Queues the end marker, block index and footer
+static int encode_trailer(CompressStream *stream) {
+    size_t size = CONTAINER_BLOCK_HEADER_SIZE + (size_t)stream->block_count * CONTAINER_INDEX_ENTRY_SIZE +
+                  CONTAINER_FOOTER_SIZE;
+    if (size > stream->out_capacity) {
+        uint8_t *out = realloc(stream->out, size);
+        if (!out) return CONTAINER_ERR_MEMORY;
+        stream->out = out;
+        stream->out_capacity = size;
+    }
+
+    ContainerBlockHeader end = { .codec = CONTAINER_CODEC_END };
+    container_put_block_header(stream->out, &end);
+
+    ContainerFooter footer = {
+        .index_offset = stream->pos + CONTAINER_BLOCK_HEADER_SIZE,
+        .raw_total = stream->raw_total,
+        .block_count = stream->block_count
+    };
+
+    size_t pos = CONTAINER_BLOCK_HEADER_SIZE;
+    for (uint32_t i = 0; i < stream->block_count; i++) {
+        container_put_index_entry(stream->out + pos, &stream->index[i]);
+        pos += CONTAINER_INDEX_ENTRY_SIZE;
+    }
+    container_put_footer(stream->out + pos, &footer);
+
+    stream->queue = stream->out;
+    stream->queue_size = size;
+    stream->pos += size;
+    stream->trailer_written = 1;
+    return CONTAINER_OK;
+}
+
+// Refills the output queue once it is empty: next block of the batch, next batch, or the trailer
+static int cstream_pump(CompressStream *stream) {
+    if (stream->queue_pos < stream->queue_size) return CONTAINER_OK;
+    stream->queue_pos = stream->queue_size = 0;
+
+    if (stream->emit_next < stream->emit_count) {
+        const StreamBlock *block = &stream->blocks[stream->emit_next++];
+        stream->queue = block->data;
+        stream->queue_size = block->data_size;
+        return CONTAINER_OK;
+    }
+    if (stream->emit_count) {
+        // The whole batch is out, its blocks can take input again
+        for (int i = 0; i < stream->emit_count; i++) stream->blocks[i].raw_size = 0;
+        stream->emit_count = stream->emit_next = 0;
+        stream->filled = 0;
+    }
+
+    int pending = stream->filled;
+    if (pending < stream->threads && stream->blocks[pending].raw_size > 0) pending++;
+    if (stream->filled == stream->threads || (stream->finishing && pending)) {
+        int err = encode_batch(stream, pending);
+        return err ? err : cstream_pump(stream);
+    }
+    if (stream->finishing && !stream->trailer_written) return encode_trailer(stream);
+    return CONTAINER_OK;
+}
+
+int cstream_feed(CompressStream *stream, const uint8_t *input, size_t size, size_t *consumed) {
+    *consumed = 0;
+    if (stream->finishing && size) return CONTAINER_ERR_RANGE;
+
+    while (*consumed < size) {
+        if (stream->filled == stream->threads) {
+            if (stream->queue_pos < stream->queue_size || stream->emit_count) break;  // caller has to drain first
+            int err = cstream_pump(stream);
+            if (err) return err;
+            continue;
+        }
+
+        StreamBlock *block = &stream->blocks[stream->filled];
+        size_t take = min_size(size - *consumed, stream->block_size - block->raw_size);
+        memcpy(block->raw + block->raw_size, input + *consumed, take);
+        block->raw_size += take;
+        *consumed += take;
+        if (block->raw_size == stream->block_size) stream->filled++;
+    }
+    return CONTAINER_OK;
+}
+
+int cstream_drain(CompressStream *stream, uint8_t *output, size_t capacity, size_t *produced) {
+    *produced = 0;
+    while (*produced < capacity) {
+        int err = cstream_pump(stream);
+        if (err) return err;
+        if (stream->queue_pos == stream->queue_size) break;
+
+        size_t take = min_size(capacity - *produced, stream->queue_size - stream->queue_pos);
+        memcpy(output + *produced, stream->queue + stream->queue_pos, take);
+        stream->queue_pos += take;
+        *produced += take;
+    }
+    return CONTAINER_OK;
+}
+
+int cstream_finish(CompressStream *stream) {
+    stream->finishing = 1;
+    return CONTAINER_OK;
+}
+
+int cstream_done(CompressStream *stream) {
+    return stream->trailer_written && stream->queue_pos == stream->queue_size;
+}
+
+void cstream_free(CompressStream *stream) {
+    free_blocks(stream->blocks, stream->threads);
+    free(stream->out);
+    free(stream->index);
+    memset(stream, 0, sizeof(*stream));
+}
+
+// ----------------- Decompression -----------------
+int dstream_init(DecompressStream *stream, int threads) {
+    memset(stream, 0, sizeof(*stream));
+    stream->state = DSTREAM_FILE_HEADER;
+    stream->threads = threads > 0 ? threads : parallel_threads();
+    return CONTAINER_OK;
+}
+
+static size_t record_size(int state) {
+    switch (state) {
+        case DSTREAM_FILE_HEADER: return CONTAINER_FILE_HEADER_SIZE;
+        case DSTREAM_BLOCK_HEADER: return CONTAINER_BLOCK_HEADER_SIZE;
+        case DSTREAM_INDEX: return CONTAINER_INDEX_ENTRY_SIZE;
+        default: return CONTAINER_FOOTER_SIZE;
+    }
+}
+
+// Decodes one received payload and checks its CRC; runs on a worker
+static void *decode_block_task(void *arg) {
+    StreamBlock *block = arg;
+    const ContainerBlockHeader *header = &block->header;
+
+    if (header->codec == CONTAINER_CODEC_RAW) {
+        memcpy(block->raw, block->data, header->raw_size);
+        block->err = CONTAINER_OK;
+    } else {
+        block->err = block->codec->decompress(block->data, header->payload_size, block->raw, header->raw_size);
+    }
+    if (!block->err && container_verify_block(header, block->raw) != CONTAINER_OK) block->err = CONTAINER_ERR_CHECKSUM;
+    block->raw_size = header->raw_size;
+    return NULL;
+}
+
+// Decodes the received blocks concurrently and queues them for draining in order
+static int decode_batch(DecompressStream *stream) {
+    parallel_run(decode_block_task, stream->blocks, sizeof(StreamBlock), stream->received);
+
+    for (int i = 0; i < stream->received; i++) {
+        if (stream->blocks[i].err) return stream->blocks[i].err;
+        stream->raw_total += stream->blocks[i].raw_size;
+        stream->block_count++;
+    }
+
+    stream->emit_count = stream->received;
+    stream->emit_next = 0;
+    stream->received = 0;
+    return CONTAINER_OK;
+}
+
+// Moves on to the next decoded block once the current one is drained
+static void dstream_advance(DecompressStream *stream) {
+    while (stream->queue_pos == stream->queue_size && stream->emit_next < stream->emit_count) {
+        const StreamBlock *block = &stream->blocks[stream->emit_next++];
+        stream->queue = block->raw;
+        stream->queue_size = block->raw_size;
+        stream->queue_pos = 0;
+    }
+    if (stream->queue_pos == stream->queue_size) stream->emit_count = stream->emit_next = 0;
+}
+
+// A block's payload is complete; the batch is decoded once every slot holds one
+static int payload_done(DecompressStream *stream) {
+    stream->received++;
+    stream->state = DSTREAM_BLOCK_HEADER;
+    return stream->received == stream->threads ? decode_batch(stream) : CONTAINER_OK;
+}
+
+static int process_record(DecompressStream *stream) {
+    switch (stream->state) {
+        case DSTREAM_FILE_HEADER: {
+            int err = container_get_file_header(stream->record, &stream->block_size);
+            if (err) return err;
+
+            // Raw buffers come with the blocks, so a short container never costs threads * block_size
+            stream->blocks = calloc(stream->threads, sizeof(StreamBlock));
+            if (!stream->blocks) return CONTAINER_ERR_MEMORY;
+
+            stream->state = DSTREAM_BLOCK_HEADER;
+            return CONTAINER_OK;
+        }
+
+        case DSTREAM_BLOCK_HEADER: {
+            ContainerBlockHeader header;
+            int err = container_get_block_header(stream->record, &header);
+            if (err) return err;
+
+            if (header.codec == CONTAINER_CODEC_END) {
+                stream->index_offset = stream->pos;
+                if (stream->received && (err = decode_batch(stream))) return err;
+                stream->state = stream->block_count ? DSTREAM_INDEX : DSTREAM_FOOTER;
+                return CONTAINER_OK;
+            }
+            // Reject payloads larger than their codec can produce before allocating for them
+            const StreamCodec *codec = stream_codec(header.codec);
+            if (header.codec == CONTAINER_CODEC_RAW) {
+                if (header.payload_size != header.raw_size) return CONTAINER_ERR_FORMAT;
+            } else if (!codec || header.payload_size > codec->bound(header.raw_size)) {
+                return CONTAINER_ERR_FORMAT;
+            }
+            if (header.raw_size > stream->block_size) return CONTAINER_ERR_FORMAT;
+
+            StreamBlock *block = &stream->blocks[stream->received];
+            if (!block->raw && !(block->raw = malloc(stream->block_size))) return CONTAINER_ERR_MEMORY;
+            if (header.payload_size > block->data_capacity) {
+                uint8_t *data = realloc(block->data, header.payload_size);
+                if (!data) return CONTAINER_ERR_MEMORY;
+                block->data = data;
+                block->data_capacity = header.payload_size;
+            }
+
+            block->codec = codec;
+            block->header = header;
+            block->data_size = 0;
+            stream->state = DSTREAM_PAYLOAD;
+            return header.payload_size ? CONTAINER_OK : payload_done(stream);
+        }
+
+        case DSTREAM_INDEX: {
+            // The index only serves seeking readers; check it is consistent with what we decoded
+            ContainerIndexEntry entry;
+            container_get_index_entry(stream->record, &entry);
+            if (entry.raw_offset != stream->index_raw_offset) return CONTAINER_ERR_FORMAT;
+            stream->index_raw_offset += entry.raw_size;
+            if (++stream->index_seen == stream->block_count) stream->state = DSTREAM_FOOTER;
+            return CONTAINER_OK;
+        }
+
+        default: {
+            ContainerFooter footer;
+            int err = container_get_footer(stream->record, &footer);
+            if (err) return err;
+            if (footer.index_offset != stream->index_offset || footer.raw_total != stream->raw_total ||
+                footer.block_count != stream->block_count || stream->index_raw_offset != stream->raw_total) {
+                return CONTAINER_ERR_FORMAT;
+            }
+            stream->state = DSTREAM_DONE;
+            return CONTAINER_OK;
+        }
+    }
+}
+
+int dstream_feed(DecompressStream *stream, const uint8_t *input, size_t size, size_t *consumed) {
+    *consumed = 0;
+    if (stream->state == DSTREAM_ERROR) return CONTAINER_ERR_FORMAT;
+
+    int err = CONTAINER_OK;
+    while (*consumed < size && !err) {
+        dstream_advance(stream);
+        if (stream->queue_pos < stream->queue_size) break;  // caller has to drain first
+
+        if (stream->state == DSTREAM_DONE) {
+            err = CONTAINER_ERR_FORMAT;  // trailing garbage after the footer
+        } else if (stream->state == DSTREAM_PAYLOAD) {
+            StreamBlock *block = &stream->blocks[stream->received];
+            size_t take = min_size(size - *consumed, block->header.payload_size - block->data_size);
+            memcpy(block->data + block->data_size, input + *consumed, take);
+            block->data_size += take;
+            stream->pos += take;
+            *consumed += take;
+            if (block->data_size == block->header.payload_size) err = payload_done(stream);
+        } else {
+            size_t need = record_size(stream->state);
+            size_t take = min_size(size - *consumed, need - stream->record_fill);
+            memcpy(stream->record + stream->record_fill, input + *consumed, take);
+            stream->record_fill += take;
+            stream->pos += take;
+            *consumed += take;
+            if (stream->record_fill == need) {
+                stream->record_fill = 0;
+                err = process_record(stream);
+            }
+        }
+    }
+
+    if (err) stream->state = DSTREAM_ERROR;
+    return err;
+}
+
+int dstream_drain(DecompressStream *stream, uint8_t *output, size_t capacity, size_t *produced) {
+    *produced = 0;
+    while (*produced < capacity) {
+        dstream_advance(stream);
+        if (stream->queue_pos == stream->queue_size) break;
+
+        size_t take = min_size(capacity - *produced, stream->queue_size - stream->queue_pos);
+        memcpy(output + *produced, stream->queue + stream->queue_pos, take);
+        stream->queue_pos += take;
+        *produced += take;
+    }
+    return CONTAINER_OK;
+}
+
+int dstream_finish(DecompressStream *stream) {
+    return stream->state == DSTREAM_DONE ? CONTAINER_OK : CONTAINER_ERR_FORMAT;
+}
+
+int dstream_pending(DecompressStream *stream) {
+    dstream_advance(stream);
+    return stream->queue_pos < stream->queue_size;
+}
+
+void dstream_free(DecompressStream *stream) {
+    free_blocks(stream->blocks, stream->threads);
+    memset(stream, 0, sizeof(*stream));
+}
@@ -0,0 +1,133 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "container.h"
+
+/*
+streaming compression into the block container with bounded memory
+
+input is cut into blocks of block_size bytes; blocks are independent, so a
+stream with N threads collects N of them, encodes (or decodes) the batch on
+N workers and hands the results out in order; the batch must be drained
+before more input is accepted, so a stream never holds more than N raw
+blocks and N encoded blocks (plus 24 bytes of index per block written)
+
+usage, for both directions:
+    init, then feed input and drain output until all input is consumed,
+    then finish and drain until nothing more comes out
+feed may consume less than it was given when output is waiting; drain, then
+feed the rest
+*/
+
+#define STREAM_DEFAULT_BLOCK_SIZE (1u << 20)
+
+// A block codec plugged into the stream driver
+typedef struct {
+    uint8_t id;                                                            // CONTAINER_CODEC_*
+    size_t (*bound)(size_t size);                                          // worst-case payload size
+    int (*compress)(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size);
+    int (*decompress)(const uint8_t *input, size_t input_size, uint8_t *output, size_t size);
+    // Codecs with a Huffman and a rANS variant only, NULL elsewhere: codes the block with
+    // whichever coder its histogram favours and sets *id to the variant that decodes it
+    int (*compress_select)(const uint8_t *input, size_t size, uint8_t *output, size_t *output_size, uint8_t *id);
+} StreamCodec;
+
+// Codec registered for a CONTAINER_CODEC_* id, NULL for RAW, END and unknown ids (codecs.c)
+const StreamCodec *stream_codec(uint8_t id);
+
+/*
+entropy coder choice for codecs with compress_select, process-wide:
+STREAM_ENTROPY_FIXED (the default) codes every block with the codec it was
+given, STREAM_ENTROPY_AUTO lets each block pick its variant (codecs.c)
+*/
+enum { STREAM_ENTROPY_FIXED, STREAM_ENTROPY_AUTO };
+void stream_set_entropy(int mode);
+int stream_entropy(void);
+
+// One block of a batch: raw bytes on one side, block header + payload on the other
+typedef struct {
+    const StreamCodec *codec;
+    ContainerBlockHeader header;
+
+    uint8_t *raw;
+    size_t raw_size;
+
+    uint8_t *data;          // block header + payload (compression), payload only (decompression)
+    size_t data_size;
+    size_t data_capacity;
+
+    int err;
+} StreamBlock;
+
+typedef struct {
+    const StreamCodec *codec;
+    uint32_t block_size;
+    int threads;
+
+    StreamBlock *blocks;    // `threads` blocks, filled in order and encoded together
+    int filled;             // blocks holding a full block_size of input
+    int emit_count;         // encoded blocks of the current batch
+    int emit_next;          // next of those to hand to the output queue
+
+    uint8_t *out;           // file header and trailer
+    size_t out_capacity;
+
+    const uint8_t *queue;   // encoded bytes waiting to be drained (points into out or a block)
+    size_t queue_size;
+    size_t queue_pos;
+
+    ContainerIndexEntry *index;
+    uint32_t block_count;
+    uint32_t index_capacity;
+    uint64_t pos;           // container bytes produced so far
+    uint64_t raw_total;
+
+    int finishing;
+    int trailer_written;
+} CompressStream;
+
+typedef struct {
+    int state;
+    uint32_t block_size;
+    int threads;
+
+    uint8_t record[CONTAINER_FOOTER_SIZE];  // file header, block header, index entry or footer being received
+    size_t record_fill;
+
+    StreamBlock *blocks;    // `threads` blocks, allocated once the file header is in
+    int received;           // blocks whose payload is complete, waiting to be decoded
+    int emit_count;         // decoded blocks of the current batch
+    int emit_next;          // next of those to hand to the output queue
+
+    const uint8_t *queue;   // decoded bytes waiting to be drained (points into a block)
+    size_t queue_size;
+    size_t queue_pos;
+
+    uint64_t pos;           // container bytes consumed so far
+    uint64_t raw_total;
+    uint64_t index_offset;
+    uint32_t block_count;
+    uint32_t index_seen;
+    uint64_t index_raw_offset;
+} DecompressStream;
+
+// ----------------- Compression -----------------
+// NULL codec stores raw; threads <= 0 uses parallel_threads()
+int cstream_init(CompressStream *stream, const StreamCodec *codec, uint32_t block_size, int threads);
+int cstream_feed(CompressStream *stream, const uint8_t *input, size_t size, size_t *consumed);
+int cstream_drain(CompressStream *stream, uint8_t *output, size_t capacity, size_t *produced);
+int cstream_finish(CompressStream *stream);  // no more input; drain until it produces nothing
+int cstream_done(CompressStream *stream);  // trailer written and drained
+void cstream_free(CompressStream *stream);
+
+// ----------------- Decompression -----------------
+int dstream_init(DecompressStream *stream, int threads);  // blocks may use any registered codec
+int dstream_feed(DecompressStream *stream, const uint8_t *input, size_t size, size_t *consumed);
+int dstream_drain(DecompressStream *stream, uint8_t *output, size_t capacity, size_t *produced);
+int dstream_finish(DecompressStream *stream);  // CONTAINER_ERR_FORMAT if the container was cut short
+int dstream_pending(DecompressStream *stream);  // decoded bytes are waiting to be drained
+void dstream_free(DecompressStream *stream);
+
+#endif